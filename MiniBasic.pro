@@ -2,26 +2,30 @@ QT       += core gui
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
-CONFIG += c++11
+CONFIG += c++17
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+include(core.pri)
+
 SOURCES += \
-    expression.cpp \
+    guiio.cpp \
     main.cpp \
     mainwindow.cpp \
-    parser.cpp \
-    statement.cpp \
-    tokenizer.cpp
+    profiledialog.cpp \
+    programcodemodel.cpp \
+    programrunner.cpp \
+    syntaxtreemodel.cpp
 
 HEADERS += \
-    expression.h \
+    guiio.h \
     mainwindow.h \
-    parser.h \
-    statement.h \
-    tokenizer.h
+    profiledialog.h \
+    programcodemodel.h \
+    programrunner.h \
+    syntaxtreemodel.h
 
 FORMS += \
     mainwindow.ui
@@ -0,0 +1,77 @@
+#include "arena.h"
+#include <cstring>
+
+Arena::Arena(size_t blockSize) : blockSize(blockSize) {}
+
+Arena::~Arena() {
+    reset();
+}
+
+void Arena::addBlock(size_t minSize) {
+    size_t size = minSize > blockSize ? minSize : blockSize;
+    blocks.push_back({new char[size], size, 0});
+}
+
+void *Arena::allocate(size_t size, size_t align) {
+    if (!blocks.empty()) {
+        Block &b = blocks.back();
+        // 对齐：data 来自 new char[]，满足基本对齐，这里只需对齐偏移量
+        size_t offset = (b.used + align - 1) & ~(align - 1);
+        if (offset + size <= b.size) {
+            b.used = offset + size;
+            return b.data + offset;
+        }
+    }
+
+    // 当前块放不下，申请新块（超大对象单独一块）
+    addBlock(size + align);
+    Block &b = blocks.back();
+    b.used = size;
+    return b.data;
+}
+
+std::string_view Arena::copyString(std::string_view s) {
+    if (s.empty()) return std::string_view();
+    char *mem = static_cast<char*>(allocate(s.size(), 1));
+    std::memcpy(mem, s.data(), s.size());
+    return std::string_view(mem, s.size());
+}
+
+Arena::Mark Arena::mark() const {
+    if (blocks.empty()) return {0, 0};
+    return {blocks.size(), blocks.back().used};
+}
+
+void Arena::rollback(const Mark &m) {
+    while (blocks.size() > m.block) {
+        delete[] blocks.back().data;
+        blocks.pop_back();
+    }
+    if (!blocks.empty()) blocks.back().used = m.used;
+}
+
+void Arena::reset() {
+    for (Block &b : blocks) delete[] b.data;
+    blocks.clear();
+}
+
+void Arena::adopt(Arena &other) {
+    if (&other == this || other.blocks.empty()) return;
+
+    // 插在当前块之前：当前块仍在末尾，后续分配继续使用它剩余的空间
+    auto pos = blocks.empty() ? blocks.end() : blocks.end() - 1;
+    blocks.insert(pos, other.blocks.begin(), other.blocks.end());
+    other.blocks.clear();
+}
+
+size_t Arena::bytesUsed() const {
+    size_t total = 0;
+    for (const Block &b : blocks) total += b.used;
+    return total;
+}
+
+size_t Arena::bytesReserved() const {
+    size_t total = 0;
+    for (const Block &b : blocks) total += b.size;
+    return total;
+}
@@ -0,0 +1,68 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// === 区域分配器 (Arena / bump allocator) ===
+// 一个程序的所有语法树节点都从同一个 Arena 里按顺序切出来：
+//   - 节点在内存中紧挨着，遍历时缓存友好
+//   - 分配只是移动指针，没有逐个 new 的开销
+//   - 释放时整块归还，不需要递归 delete 每个节点
+// 注意：Arena 不调用对象的析构函数，放进来的类型不能自己持有堆内存
+// （字符串请用 copyString 复制到 Arena 里，再以 std::string_view 保存）。
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 64 * 1024);
+    ~Arena();
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    // 在 Arena 中构造一个 T
+    template <typename T, typename... Args>
+    T *make(Args&&... args) {
+        void *mem = allocate(sizeof(T), alignof(T));
+        return new (mem) T(std::forward<Args>(args)...);
+    }
+
+    // 把字符串复制进 Arena，返回指向副本的视图
+    std::string_view copyString(std::string_view s);
+
+    void *allocate(size_t size, size_t align);
+
+    // 分配位置的快照：解析出错时 rollback 回去，丢弃这次解析分配的所有节点
+    struct Mark {
+        size_t block;
+        size_t used;
+    };
+    Mark mark() const;
+    void rollback(const Mark &m);
+
+    // 一次性释放所有节点
+    void reset();
+
+    // 【新增】接管另一个 Arena 的所有块（other 变为空），节点地址不变。
+    // 用于把各工作线程各自分配的节点合并到同一个所有者中；之前取的 Mark 随之失效
+    void adopt(Arena &other);
+
+    size_t bytesUsed() const;      // 已分配给对象的字节数
+    size_t bytesReserved() const;  // 向系统申请的总字节数
+
+private:
+    struct Block {
+        char *data;
+        size_t size;
+        size_t used;
+    };
+
+    std::vector<Block> blocks;
+    size_t blockSize;
+
+    void addBlock(size_t minSize);
+};
+
+#endif // ARENA_H
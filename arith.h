@@ -0,0 +1,75 @@
+#ifndef ARITH_H
+#define ARITH_H
+
+#include <climits>
+#include <stdexcept>
+
+// === BASIC 整数运算 ===
+// 树遍历 (BinaryExp::eval 等)、字节码虚拟机以及其他执行引擎共用这里的定义，
+// 保证除法 / MOD / 幂运算在所有引擎里的结果和报错完全一致。
+
+// INT_MIN / -1 的商超出 int 范围（硬件上会触发异常），报错而不是让进程崩溃
+inline int basicDiv(int leftVal, int rightVal) {
+    if (rightVal == 0) throw std::runtime_error("Division by zero");
+    if (rightVal == -1 && leftVal == INT_MIN) throw std::runtime_error("Integer overflow in /");
+    return leftVal / rightVal;
+}
+
+// 题目要求：r 的符号与 b (rightVal) 相同
+// 对 -1 取模总是 0；不能交给 %，INT_MIN % -1 同样会触发硬件异常
+inline int basicMod(int leftVal, int rightVal) {
+    if (rightVal == 0) throw std::runtime_error("Division by zero");
+    if (rightVal == -1) return 0;
+    int r = leftVal % rightVal;
+    if ((rightVal > 0 && r < 0) || (rightVal < 0 && r > 0)) {
+        r += rightVal;
+    }
+    return r;
+}
+
+inline int checkedPowResult(long long r) {
+    if (r > INT_MAX || r < INT_MIN) throw std::runtime_error("Integer overflow in **");
+    return (int)r;
+}
+
+// 平方 / 立方：常数指数的快速路径
+inline int basicSquare(int base) {
+    return checkedPowResult((long long)base * base);
+}
+
+inline int basicCube(int base) {
+    return checkedPowResult((long long)basicSquare(base) * base);
+}
+
+// 整数幂运算（快速幂，按位平方），结果与精确整数运算一致：
+//   - 指数为负：相当于 1 / base^n 向 0 取整，即 1 ** n = 1，(-1) ** n = ±1，其余为 0；
+//     0 的负数次幂报 "Division by zero"
+//   - 结果超出 int 范围时报 "Integer overflow in **"，不会悄悄截断
+inline int basicPow(int base, int exponent) {
+    switch (exponent) {
+    case 0: return 1;
+    case 1: return base;
+    case 2: return basicSquare(base);
+    case 3: return basicCube(base);
+    }
+
+    if (exponent < 0) {
+        if (base == 0) throw std::runtime_error("Division by zero");
+        if (base == 1) return 1;
+        if (base == -1) return (exponent & 1) ? -1 : 1;
+        return 0;
+    }
+
+    long long result = 1;
+    long long b = base;
+    while (true) {
+        if (exponent & 1) result = checkedPowResult(result * b);
+        exponent >>= 1;
+        if (exponent == 0) break;
+        // 还有更高的位要乘：|b| >= 2 时 b 的平方超出范围，最终结果也一定超出
+        b = checkedPowResult(b * b);
+    }
+    return (int)result;
+}
+
+#endif // ARITH_H
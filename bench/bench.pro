@@ -0,0 +1,16 @@
+# 性能基准：解析吞吐、树遍历 / 虚拟机语句吞吐、分配次数、峰值内存
+# 用法: bench [--cases DIR] [--min-time MS] [--label NAME] [--json FILE]
+# 建议用 Release 构建；--json 的结果可按提交保存，用来比较前后差异
+
+TEMPLATE = app
+TARGET = bench
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(../core.pri)
+
+win32: LIBS += -lpsapi
+
+SOURCES += \
+    main.cpp
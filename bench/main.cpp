@@ -0,0 +1,397 @@
+#include "interpreter.h"
+#include "flatast.h"
+#include "io.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+#include <dirent.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// 性能基准：测量解析吞吐、各执行引擎的语句吞吐、内存分配次数和峰值内存，
+// 结果同时以表格（stderr）和 JSON（--json 文件或 stdout）输出，便于跨提交对比。
+// 用法: bench [--cases DIR] [--min-time MS] [--label NAME] [--json FILE]
+
+// ==========================================================
+// 分配计数：替换全局 operator new / delete
+// ==========================================================
+
+// 大程序由多个线程并行解析（见 parallelparse.h），计数器必须是原子的；
+// 只需要总数，不需要与其他内存操作排序
+static std::atomic<long long> allocCount{0};
+static std::atomic<long long> allocBytes{0};
+
+// delete 不能内联：内联后 GCC 在调用处看到 operator new 的结果被 free 释放，
+// 会误报 -Wmismatched-new-delete
+#if defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+void *operator new(size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add((long long)size, std::memory_order_relaxed);
+    void *p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void *operator new[](size_t size) { return operator new(size); }
+BENCH_NOINLINE void operator delete(void *p) noexcept { std::free(p); }
+BENCH_NOINLINE void operator delete[](void *p) noexcept { std::free(p); }
+BENCH_NOINLINE void operator delete(void *p, size_t) noexcept { std::free(p); }
+BENCH_NOINLINE void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+static long peakMemoryKB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return -1;
+    return (long)(pmc.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // macOS 以字节为单位
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// ==========================================================
+// 输入输出：输出只计数不显示，INPUT 一律读到 0
+// ==========================================================
+
+class CountingSink : public OutputSink {
+public:
+    long long lines = 0;
+    virtual void writeLine(const std::string &) override { lines++; }
+};
+
+class ZeroInput : public InputSource {
+public:
+    virtual int readInt(const std::string &) override { return 0; }
+};
+
+// ==========================================================
+// 工作负载
+// ==========================================================
+
+struct Workload {
+    std::string name;
+    std::map<int, std::string> source;
+};
+
+// 深层嵌套表达式：每层套一对括号，运算符轮流使用，带变量以免被常量折叠
+static std::string deepExpression(int depth) {
+    static const char *steps[] = {" + A)", " * 3)", " MOD 1009)", " - B)"};
+    std::string exp = "A";
+    for (int i = 0; i < depth; i++) {
+        exp = "(" + exp + steps[i % 4];
+    }
+    return exp;
+}
+
+static Workload deepExpressions() {
+    Workload w{"deep-expressions", {}};
+    w.source[10] = "LET I = 0";
+    w.source[20] = "LET A = I MOD 97";
+    w.source[30] = "LET B = I MOD 13";
+    for (int i = 0; i < 50; i++) {
+        w.source[100 + i] = "LET X = " + deepExpression(64);
+    }
+    w.source[1000] = "LET I = I + 1";
+    w.source[1010] = "IF I < 200 THEN 20";
+    return w;
+}
+
+static Workload hugeProgram() {
+    Workload w{"100k-lines", {}};
+    for (int i = 0; i < 100000; i++) {
+        std::string var = std::string(1, (char)('A' + i % 26)) + std::to_string(i % 10);
+        std::string prev = std::string(1, (char)('A' + (i + 7) % 26)) + std::to_string((i + 3) % 10);
+        w.source[i + 1] = "LET " + var + " = " + prev + " * 3 + " + std::to_string(i) + " MOD 7";
+    }
+    return w;
+}
+
+static Workload ifGotoLoop() {
+    Workload w{"if-goto-loop", {}};
+    w.source[10] = "LET I = 0";
+    w.source[20] = "LET I = I + 1";
+    w.source[30] = "IF I < 2000000 THEN 20";
+    w.source[40] = "END";
+    return w;
+}
+
+static Workload printHeavy() {
+    Workload w{"print-heavy", {}};
+    w.source[10] = "LET I = 0";
+    w.source[20] = "PRINT I * 3";
+    w.source[30] = "LET I = I + 1";
+    w.source[40] = "IF I < 200000 THEN 20";
+    return w;
+}
+
+static void addTestcases(const std::string &dir, std::vector<Workload> &workloads) {
+    DIR *d = opendir(dir.c_str());
+    if (!d) {
+        std::fprintf(stderr, "warning: cannot open %s, skipping testcases\n", dir.c_str());
+        return;
+    }
+    std::vector<std::string> names;
+    while (dirent *entry = readdir(d)) {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0) names.push_back(name);
+    }
+    closedir(d);
+
+    std::sort(names.begin(), names.end());
+    for (const std::string &name : names) {
+        workloads.push_back({name, loadSourceFile(dir + "/" + name)});
+    }
+}
+
+// ==========================================================
+// 测量
+// ==========================================================
+
+struct Result {
+    std::string name;
+    long long lines = 0;
+    double parseMs = 0;          // 每次解析的平均时间
+    long long parseAllocs = 0;   // 每次解析的分配次数
+    long long parseAllocBytes = 0;
+    long long statements = 0;    // 一次运行执行的语句条数
+    double treeMs = 0;
+    double vmMs = 0;
+    long long vmAllocs = 0;      // 一次 VM 运行（含编译）的分配次数
+    double jitMs = 0;            // 含解释阶段和生成机器码的时间
+    double flatMs = 0;           // 扁平语法树缓存在 Program 中，只有第一次运行含转换时间
+    long long exprNodes = 0;     // 执行用的表达式节点数
+    long long treeExprBytes = 0; // 这些节点作为 Expression 对象占用的字节
+    long long flatExprBytes = 0; // 作为 FlatNode 占用的字节
+    long long outputLines = 0;
+    std::string error;
+};
+
+// 执行用表达式树的节点对象大小之和（带常数操作数的特化节点多 8 字节，按 CompoundExp 估计）
+static long long treeBytes(Expression *exp) {
+    switch (exp->type()) {
+    case CONSTANT: return sizeof(ConstantExp);
+    case IDENTIFIER: return sizeof(IdentifierExp);
+    default: return sizeof(CompoundExp) + treeBytes(exp->getLHS()) + treeBytes(exp->getRHS());
+    }
+}
+
+static long long treeBytes(const Program &program) {
+    long long bytes = 0;
+    for (int i = 0; i < program.size(); i++) {
+        Statement *stmt = program.at(i);
+        switch (stmt->type()) {
+        case LET_STMT: case PRINT_STMT: bytes += treeBytes(stmt->getExp()); break;
+        case IF_STMT: bytes += treeBytes(stmt->getLHS()) + treeBytes(stmt->getRHS()); break;
+        default: break;
+        }
+    }
+    return bytes;
+}
+
+static double nowMs() {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 重复执行 fn，直到累计时间超过 minMs，返回平均每次的毫秒数
+template <typename F>
+static double averageMs(F fn, double minMs) {
+    int reps = 0;
+    double start = nowMs(), elapsed = 0;
+    do {
+        fn();
+        reps++;
+        elapsed = nowMs() - start;
+    } while (elapsed < minMs);
+    return elapsed / reps;
+}
+
+static Result measure(const Workload &w, double minMs) {
+    Result r;
+    r.name = w.name;
+    r.lines = (long long)w.source.size();
+
+    CountingSink sink;
+    ZeroInput input;
+    EvaluationContext context;
+    context.setIO(&sink, &input);
+
+    try {
+        // 1. 解析：先单独测一次分配，再重复计时
+        {
+            long long count0 = allocCount, bytes0 = allocBytes;
+            Program program;
+            parseProgram(w.source, context, program);
+            r.parseAllocs = allocCount - count0;
+            r.parseAllocBytes = allocBytes - bytes0;
+        }
+        r.parseMs = averageMs([&]() {
+            Program program;
+            parseProgram(w.source, context, program);
+        }, minMs);
+
+        Program program;
+        parseProgram(w.source, context, program);
+
+        // 2. 树遍历：同时得到执行的语句条数
+        context.clear();
+        r.statements = program.run(context);
+        r.outputLines = sink.lines;
+        r.treeMs = averageMs([&]() {
+            context.clear();
+            program.run(context);
+        }, minMs);
+
+        // 3. 字节码虚拟机（含编译时间）
+        context.clear();
+        long long count0 = allocCount;
+        executeProgram(program, context, ENGINE_BYTECODE);
+        r.vmAllocs = allocCount - count0;
+        r.vmMs = averageMs([&]() {
+            context.clear();
+            executeProgram(program, context, ENGINE_BYTECODE);
+        }, minMs);
+
+        // 4. JIT（热循环编译成机器码）
+        r.jitMs = averageMs([&]() {
+            context.clear();
+            executeProgram(program, context, ENGINE_JIT);
+        }, minMs);
+
+        // 5. 扁平语法树，同时比较两种表达式存储的大小
+        const FlatProgram &flat = program.flat();
+        r.exprNodes = flat.nodeCount();
+        r.flatExprBytes = (long long)flat.nodeBytes();
+        r.treeExprBytes = treeBytes(program);
+        r.flatMs = averageMs([&]() {
+            context.clear();
+            executeProgram(program, context, ENGINE_FLAT);
+        }, minMs);
+    }
+    catch (std::exception &e) {
+        r.error = e.what();
+    }
+    return r;
+}
+
+static double perSecond(double count, double ms) {
+    return ms > 0 ? count * 1000.0 / ms : 0;
+}
+
+static std::string jsonString(const std::string &s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static void writeJson(std::FILE *out, const std::string &label, const std::vector<Result> &results) {
+    std::fprintf(out, "{\n  \"label\": %s,\n  \"peak_memory_kb\": %ld,\n  \"workloads\": [\n",
+                 jsonString(label).c_str(), peakMemoryKB());
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &r = results[i];
+        std::fprintf(out,
+            "    {\"name\": %s, \"lines\": %lld, \"parse_ms\": %.4f, \"lines_parsed_per_sec\": %.0f, "
+            "\"parse_allocs\": %lld, \"parse_alloc_bytes\": %lld, \"statements_executed\": %lld, "
+            "\"tree_ms\": %.4f, \"tree_statements_per_sec\": %.0f, "
+            "\"vm_ms\": %.4f, \"vm_statements_per_sec\": %.0f, \"vm_allocs\": %lld, "
+            "\"jit_ms\": %.4f, \"jit_statements_per_sec\": %.0f, "
+            "\"flat_ms\": %.4f, \"flat_statements_per_sec\": %.0f, "
+            "\"expr_nodes\": %lld, \"tree_expr_bytes\": %lld, \"flat_expr_bytes\": %lld, "
+            "\"output_lines\": %lld, \"error\": %s}%s\n",
+            jsonString(r.name).c_str(), r.lines, r.parseMs, perSecond(r.lines, r.parseMs),
+            r.parseAllocs, r.parseAllocBytes, r.statements,
+            r.treeMs, perSecond(r.statements, r.treeMs),
+            r.vmMs, perSecond(r.statements, r.vmMs), r.vmAllocs,
+            r.jitMs, perSecond(r.statements, r.jitMs),
+            r.flatMs, perSecond(r.statements, r.flatMs),
+            r.exprNodes, r.treeExprBytes, r.flatExprBytes,
+            r.outputLines, r.error.empty() ? "null" : jsonString(r.error).c_str(),
+            i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+static void usage() {
+    std::fprintf(stderr, "usage: bench [--cases DIR] [--min-time MS] [--label NAME] [--json FILE]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    std::string casesDir = "y86-testcases";
+    std::string label = "";
+    const char *jsonPath = nullptr;
+    double minMs = 200;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--cases") == 0 && hasValue) casesDir = argv[++i];
+        else if (std::strcmp(argv[i], "--min-time") == 0 && hasValue) minMs = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--label") == 0 && hasValue) label = argv[++i];
+        else if (std::strcmp(argv[i], "--json") == 0 && hasValue) jsonPath = argv[++i];
+        else { usage(); return 2; }
+    }
+
+    std::vector<Workload> workloads;
+    addTestcases(casesDir, workloads);
+    workloads.push_back(deepExpressions());
+    workloads.push_back(hugeProgram());
+    workloads.push_back(ifGotoLoop());
+    workloads.push_back(printHeavy());
+
+    std::vector<Result> results;
+    std::fprintf(stderr, "%-18s %8s %14s %12s %12s %14s %14s %14s %14s %18s\n",
+                 "workload", "lines", "lines/s", "parse alloc", "stmts", "tree stmts/s", "vm stmts/s", "jit stmts/s",
+                 "flat stmts/s", "expr bytes t/f");
+    for (const Workload &w : workloads) {
+        Result r = measure(w, minMs);
+        results.push_back(r);
+        if (!r.error.empty()) {
+            std::fprintf(stderr, "%-18s error: %s\n", r.name.c_str(), r.error.c_str());
+            continue;
+        }
+        std::fprintf(stderr, "%-18s %8lld %14.0f %12lld %12lld %14.0f %14.0f %14.0f %14.0f %9lld/%-8lld\n",
+                     r.name.c_str(), r.lines, perSecond(r.lines, r.parseMs), r.parseAllocs,
+                     r.statements, perSecond(r.statements, r.treeMs), perSecond(r.statements, r.vmMs),
+                     perSecond(r.statements, r.jitMs), perSecond(r.statements, r.flatMs),
+                     r.treeExprBytes, r.flatExprBytes);
+    }
+    std::fprintf(stderr, "peak memory: %ld KB\n", peakMemoryKB());
+
+    if (jsonPath) {
+        std::FILE *out = std::fopen(jsonPath, "w");
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", jsonPath);
+            return 1;
+        }
+        writeJson(out, label, results);
+        std::fclose(out);
+    }
+    else {
+        writeJson(stdout, label, results);
+    }
+    return 0;
+}
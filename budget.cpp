@@ -0,0 +1,64 @@
+#include "budget.h"
+#include <algorithm>
+
+// ==========================================================
+// LimitExceeded 实现
+// ==========================================================
+
+LimitExceeded::LimitExceeded(Kind kind, long long limit)
+    : std::runtime_error("Execution limit exceeded"), limitKind(kind), limit(limit) {
+    format();
+}
+
+void LimitExceeded::setPosition(int lineNumber, long long executed) {
+    line = lineNumber;
+    count = executed;
+    format();
+}
+
+void LimitExceeded::format() {
+    switch (limitKind) {
+    case STATEMENTS: message = "Statement limit (" + std::to_string(limit) + ") exceeded"; break;
+    case TIME:       message = "Time limit (" + std::to_string(limit) + " ms) exceeded"; break;
+    case OUTPUT:     message = "Output limit (" + std::to_string(limit) + " lines) exceeded"; break;
+    }
+    if (line >= 0) message += " at line " + std::to_string(line);
+    if (count >= 0) message += " after " + std::to_string(count) + " statements";
+}
+
+// ==========================================================
+// ExecutionBudget 实现
+// ==========================================================
+
+ExecutionBudget::ExecutionBudget(const ExecutionLimits &limits)
+    : limits(limits), start(std::chrono::steady_clock::now()) {
+    schedule(0);
+}
+
+void ExecutionBudget::schedule(long long executed) {
+    nextCheck = LLONG_MAX;
+    if (limits.maxMillis > 0) nextCheck = executed + TIME_CHECK_INTERVAL;
+    if (limits.maxStatements > 0) nextCheck = std::min(nextCheck, limits.maxStatements);
+}
+
+void ExecutionBudget::check(long long executed, long long upcoming) {
+    if (limits.maxStatements > 0 && executed + upcoming > limits.maxStatements) {
+        throw LimitExceeded(LimitExceeded::STATEMENTS, limits.maxStatements);
+    }
+    if (limits.maxMillis > 0) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        if (elapsed.count() >= limits.maxMillis) {
+            throw LimitExceeded(LimitExceeded::TIME, limits.maxMillis);
+        }
+    }
+    schedule(executed + upcoming);
+}
+
+long long ExecutionBudget::checkPartial(long long executed, long long upcoming) {
+    if (limits.maxStatements > 0 && executed + upcoming > limits.maxStatements) {
+        upcoming = std::max(limits.maxStatements - executed, 0LL);
+        if (upcoming == 0) throw LimitExceeded(LimitExceeded::STATEMENTS, limits.maxStatements);
+    }
+    check(executed, upcoming);
+    return upcoming;
+}
@@ -0,0 +1,76 @@
+#ifndef BUDGET_H
+#define BUDGET_H
+
+#include <chrono>
+#include <climits>
+#include <stdexcept>
+#include <string>
+
+// === 执行限制 ===
+// 运行不可信的程序时限制它能用掉的资源，任何一项为 0 表示不限
+struct ExecutionLimits {
+    long long maxStatements = 0;  // 最多执行的语句条数
+    long long maxMillis = 0;      // 最长运行时间（毫秒）
+    long long maxOutputLines = 0; // 最多输出的行数
+
+    bool any() const { return maxStatements > 0 || maxMillis > 0 || maxOutputLines > 0; }
+};
+
+// 超出限制时抛出；执行引擎捕获后补上当时所在的行和已执行的语句条数再抛出
+class LimitExceeded : public std::runtime_error {
+public:
+    enum Kind { STATEMENTS, TIME, OUTPUT };
+
+    LimitExceeded(Kind kind, long long limit);
+
+    Kind kind() const { return limitKind; }
+    int lineNumber() const { return line; }      // 未知时为 -1
+    long long executed() const { return count; } // 未知时为 -1
+
+    void setPosition(int lineNumber, long long executed);
+    const char *what() const noexcept override { return message.c_str(); }
+
+private:
+    Kind limitKind;
+    long long limit;
+    int line = -1;
+    long long count = -1;
+    std::string message;
+
+    void format();
+};
+
+// === 一次运行的预算 ===
+// 执行循环只做一次整数比较：已执行条数越过 checkpoint() 时才调用 check()，
+// 由 check() 判断语句条数和时间（读时钟较慢，每 TIME_CHECK_INTERVAL 条语句才读一次）
+class ExecutionBudget {
+public:
+    explicit ExecutionBudget(const ExecutionLimits &limits);
+
+    // 即将执行 upcoming 条语句、且 executed + upcoming > checkpoint() 时调用
+    long long checkpoint() const { return nextCheck; }
+    void check(long long executed, long long upcoming);
+
+    // 【新增】与 check 相同，但语句条数只够执行 upcoming 中的一部分时不抛出，
+    // 返回还能执行的条数（一条都不能执行时照常抛出）；按基本块计数的引擎用它找到超限的那一条语句
+    long long checkPartial(long long executed, long long upcoming);
+
+    // PRINT 每输出一行调用一次
+    void countOutput() {
+        if (limits.maxOutputLines > 0 && ++outputLines > limits.maxOutputLines) {
+            throw LimitExceeded(LimitExceeded::OUTPUT, limits.maxOutputLines);
+        }
+    }
+
+private:
+    static const long long TIME_CHECK_INTERVAL = 4096;
+
+    ExecutionLimits limits;
+    long long nextCheck = LLONG_MAX;
+    long long outputLines = 0;
+    std::chrono::steady_clock::time_point start;
+
+    void schedule(long long executed);
+};
+
+#endif // BUDGET_H
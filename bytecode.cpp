@@ -0,0 +1,294 @@
+#include "bytecode.h"
+#include "arith.h"
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+// ==========================================================
+// BytecodeCompiler (编译器) 实现
+// ==========================================================
+
+static bool endsBlock(Statement *stmt) {
+    StatementType t = stmt->type();
+    return t == GOTO_STMT || t == IF_STMT || t == END_STMT;
+}
+
+BytecodeProgram BytecodeCompiler::compile(const Program &program, bool countStatements) {
+    int n = program.size();
+    prog = BytecodeProgram();
+    prog.stmtStart.assign(n, 0);
+    prog.lines.resize(n);
+    pendingJumps.clear();
+    depth = 0;
+
+    // 0. 需要计数时找出基本块的入口
+    std::vector<char> leader;
+    if (countStatements) {
+        leader.assign(n + 1, 0);
+        leader[0] = 1;
+        for (int i = 0; i < n; i++) {
+            Statement *stmt = program.at(i);
+            if (stmt->type() == GOTO_STMT || stmt->type() == IF_STMT) leader[stmt->getTarget()] = 1;
+            if (endsBlock(stmt)) leader[i + 1] = 1;
+        }
+    }
+
+    // 1. 按顺序逐条编译，记录每条语句的起始 pc
+    for (int i = 0; i < n; i++) {
+        prog.stmtStart[i] = (int)prog.code.size();
+        prog.lines[i] = program.lineAt(i);
+        if (countStatements && leader[i]) {
+            int length = 1;
+            while (i + length < n && !leader[i + length]) length++;
+            emit(OP_COUNT, length);
+        }
+        compileStatement(program.at(i));
+    }
+    emit(OP_HALT); // 执行完最后一行自然结束
+
+    // 2. 回填跳转目标：语句下标 -> pc
+    for (int pc : pendingJumps) {
+        prog.code[pc].arg = prog.stmtStart[prog.code[pc].arg];
+    }
+
+    return prog;
+}
+
+int BytecodeProgram::stmtAt(int pc) const {
+    // 最后一个起始 pc <= pc 的语句（没有指令的 REM 与下一条语句起始相同，取后者）
+    auto it = std::upper_bound(stmtStart.begin(), stmtStart.end(), pc);
+    if (it == stmtStart.begin()) return -1;
+    return (int)(it - stmtStart.begin()) - 1;
+}
+
+int BytecodeProgram::lineAt(int pc) const {
+    int stmt = stmtAt(pc);
+    return stmt < 0 ? -1 : lines[stmt];
+}
+
+void BytecodeCompiler::emit(OpCode op, int arg) {
+    prog.code.push_back({op, arg});
+
+    // 跟踪栈深度，算出虚拟机需要的最大栈
+    switch (op) {
+    case OP_PUSH: case OP_LOAD: depth++; break;
+    case OP_STORE: case OP_PRINT: depth--; break;
+    case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_MOD: case OP_POW: depth--; break;
+    case OP_JEQ: case OP_JLT: case OP_JGT: depth -= 2; break;
+    case OP_POP: depth -= arg; break;
+    default: break;
+    }
+    if (depth > prog.maxStack) prog.maxStack = depth;
+}
+
+void BytecodeCompiler::compileStatement(Statement *stmt) {
+    switch (stmt->type()) {
+    case REM_STMT:
+        break;
+
+    case LET_STMT:
+        compileExpression(stmt->getExp());
+        emit(OP_STORE, stmt->getSlot());
+        break;
+
+    case PRINT_STMT:
+        compileExpression(stmt->getExp());
+        emit(OP_PRINT);
+        break;
+
+    case INPUT_STMT:
+        emit(OP_INPUT, stmt->getSlot());
+        break;
+
+    case GOTO_STMT:
+        pendingJumps.push_back((int)prog.code.size());
+        emit(OP_JMP, stmt->getTarget());
+        break;
+
+    case IF_STMT: {
+        compileExpression(stmt->getLHS());
+        compileExpression(stmt->getRHS());
+
+        std::string op = stmt->getOperator();
+        OpCode jump;
+        if (op == "=") jump = OP_JEQ;
+        else if (op == "<") jump = OP_JLT;
+        else if (op == ">") jump = OP_JGT;
+        else {
+            // 与 IfStmt::execute 一致：不认识的比较符视为条件不成立
+            emit(OP_POP, 2);
+            break;
+        }
+        pendingJumps.push_back((int)prog.code.size());
+        emit(jump, stmt->getTarget());
+        break;
+    }
+
+    case END_STMT:
+        emit(OP_HALT);
+        break;
+    }
+}
+
+void BytecodeCompiler::compileExpression(Expression *exp) {
+    switch (exp->type()) {
+    case CONSTANT:
+        emit(OP_PUSH, exp->getConstantValue());
+        break;
+
+    case IDENTIFIER:
+        emit(OP_LOAD, exp->getSlot());
+        break;
+
+    case COMPOUND: {
+        std::string op = exp->getOperator();
+
+        // 常数指数 2 / 3：不压入指数，直接用专门的指令
+        Expression *rhs = exp->getRHS();
+        if (op == "**" && rhs->type() == CONSTANT &&
+            (rhs->getConstantValue() == 2 || rhs->getConstantValue() == 3)) {
+            compileExpression(exp->getLHS());
+            emit(rhs->getConstantValue() == 2 ? OP_SQUARE : OP_CUBE);
+            break;
+        }
+
+        // 先左后右，与 CompoundExp::eval 的求值顺序一致
+        compileExpression(exp->getLHS());
+        compileExpression(rhs);
+
+        if (op == "+") emit(OP_ADD);
+        else if (op == "-") emit(OP_SUB);
+        else if (op == "*") emit(OP_MUL);
+        else if (op == "/") emit(OP_DIV);
+        else if (op == "MOD") emit(OP_MOD);
+        else if (op == "**") emit(OP_POW);
+        else throw std::runtime_error("Illegal operator: " + op);
+        break;
+    }
+    }
+}
+
+// ==========================================================
+// VirtualMachine (虚拟机) 实现
+// ==========================================================
+
+void VirtualMachine::run(const BytecodeProgram &prog, EvaluationContext &context) {
+    std::vector<int> stackMem(prog.maxStack + 1);
+    int *sp = stackMem.data(); // 指向下一个空位
+
+    const Instruction *code = prog.code.data();
+    int pc = 0;
+
+    // 执行预算：只有 OP_COUNT 会累加和检查，一次记下整个基本块的语句条数。
+    // 出错时由当前基本块的入口 (blockPc, blockBase) 和出错的 pc 算出实际执行了多少条语句
+    ExecutionBudget *budget = context.budget();
+    long long checkpoint = budget ? budget->checkpoint() : LLONG_MAX;
+    long long executed = 0;
+    int blockPc = -1;        // 当前基本块的 OP_COUNT，没有计数时为 -1
+    long long blockBase = 0; // 进入当前基本块之前执行的语句条数
+    std::vector<Instruction> trapped; // 插入了 OP_TRAP 的指令副本，只在预算于块中间用完时生成
+    int trapStmt = -1;
+
+    try {
+        while (true) {
+            const Instruction &ins = code[pc++];
+
+            switch (ins.op) {
+            case OP_PUSH:
+                *sp++ = ins.arg;
+                break;
+
+            case OP_LOAD:
+                *sp++ = context.getSlot(ins.arg);
+                break;
+
+            case OP_STORE:
+                context.setSlot(ins.arg, *--sp);
+                break;
+
+            case OP_ADD: sp--; sp[-1] = sp[-1] + sp[0]; break;
+            case OP_SUB: sp--; sp[-1] = sp[-1] - sp[0]; break;
+            case OP_MUL: sp--; sp[-1] = sp[-1] * sp[0]; break;
+
+            case OP_DIV: sp--; sp[-1] = basicDiv(sp[-1], sp[0]); break;
+            case OP_MOD: sp--; sp[-1] = basicMod(sp[-1], sp[0]); break;
+            case OP_POW: sp--; sp[-1] = basicPow(sp[-1], sp[0]); break;
+            case OP_SQUARE: sp[-1] = basicSquare(sp[-1]); break;
+            case OP_CUBE: sp[-1] = basicCube(sp[-1]); break;
+
+            case OP_PRINT:
+                context.writeOutput(std::to_string(*--sp));
+                break;
+
+            case OP_INPUT:
+                context.setSlot(ins.arg, context.readInput(context.slotName(ins.arg)));
+                break;
+
+            // 跳转时检查停止标志（与树遍历一致）
+            case OP_JMP:
+                pc = ins.arg;
+                if (context.stopRequested()) throw ExecutionStopped();
+                break;
+
+            case OP_JEQ:
+                sp -= 2;
+                if (sp[0] == sp[1]) {
+                    pc = ins.arg;
+                    if (context.stopRequested()) throw ExecutionStopped();
+                }
+                break;
+            case OP_JLT:
+                sp -= 2;
+                if (sp[0] < sp[1]) {
+                    pc = ins.arg;
+                    if (context.stopRequested()) throw ExecutionStopped();
+                }
+                break;
+            case OP_JGT:
+                sp -= 2;
+                if (sp[0] > sp[1]) {
+                    pc = ins.arg;
+                    if (context.stopRequested()) throw ExecutionStopped();
+                }
+                break;
+
+            case OP_POP:
+                sp -= ins.arg;
+                break;
+
+            case OP_COUNT:
+                blockPc = pc - 1;
+                blockBase = executed;
+                if (executed + ins.arg > checkpoint) {
+                    long long allowed = budget->checkPartial(executed, ins.arg);
+                    checkpoint = budget->checkpoint();
+                    if (allowed < ins.arg) {
+                        // 只能执行块中前 allowed 条语句：在下一条语句的开头放一个 OP_TRAP，
+                        // 前面的语句照常执行（输出和树遍历一致）。超限后运行结束，所以只复制一次
+                        trapStmt = prog.stmtAt(blockPc) + (int)allowed;
+                        trapped = prog.code;
+                        trapped[prog.stmtStart[trapStmt]] = {OP_TRAP, 0};
+                        code = trapped.data();
+                    }
+                }
+                executed += ins.arg;
+                break;
+
+            case OP_TRAP:
+                budget->check(blockBase + (trapStmt - prog.stmtAt(blockPc)), 1); // 必然抛出
+                break;
+
+            case OP_HALT:
+                return;
+            }
+        }
+    }
+    catch (LimitExceeded &e) {
+        // pc 已经指向下一条指令。OP_TRAP 所在的语句可能是没有指令的 REM，直接用记下的下标；
+        // 没有 OP_COUNT 时不知道执行了多少条语句
+        int stmt = code[pc - 1].op == OP_TRAP ? trapStmt : prog.stmtAt(pc - 1);
+        long long count = blockPc < 0 ? -1 : blockBase + (stmt - prog.stmtAt(blockPc));
+        e.setPosition(stmt < 0 ? -1 : prog.lines[stmt], count);
+        throw;
+    }
+}
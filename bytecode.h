@@ -0,0 +1,85 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include "expression.h"
+#include "statement.h"
+#include "program.h"
+#include <string>
+#include <vector>
+
+// 执行引擎：树遍历（参考实现）、字节码虚拟机、热循环编译成机器码的 JIT（见 jit.h），
+// 或遍历扁平语法树、不调用虚函数的 ENGINE_FLAT（见 flatast.h）
+enum ExecEngine { ENGINE_TREE, ENGINE_BYTECODE, ENGINE_JIT, ENGINE_FLAT };
+
+// === 字节码指令集 ===
+// 栈式虚拟机：表达式的操作数压栈，运算符弹出两个操作数再压回结果
+enum OpCode : unsigned char {
+    OP_PUSH,    // 压入常数 arg
+    OP_LOAD,    // 压入变量槽 arg 的值
+    OP_STORE,   // 弹出栈顶，存入变量槽 arg
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_MOD,
+    OP_POW,
+    OP_SQUARE,  // 栈顶 ** 2（常数指数的快速路径）
+    OP_CUBE,    // 栈顶 ** 3
+    OP_PRINT,   // 弹出栈顶并输出
+    OP_INPUT,   // 读入一个整数，存入变量槽 arg
+    OP_JMP,     // 无条件跳转到 pc = arg
+    OP_JEQ,     // 弹出 r, l；若 l == r 跳转到 arg
+    OP_JLT,     // 弹出 r, l；若 l < r 跳转到 arg
+    OP_JGT,     // 弹出 r, l；若 l > r 跳转到 arg
+    OP_POP,     // 丢弃栈顶 arg 个值（IF 的比较符不认识时使用）
+    OP_COUNT,   // 基本块入口：接下来会执行 arg 条语句，检查执行预算（只在有限制时生成）
+    OP_TRAP,    // 语句预算在基本块中间用完：运行时临时替换该语句的第一条指令，执行到时报告超限
+    OP_HALT     // 程序结束
+};
+
+struct Instruction {
+    OpCode op;
+    int arg;
+};
+
+// 一段编译好的程序
+struct BytecodeProgram {
+    std::vector<Instruction> code;
+    int maxStack = 0; // 运行时需要的最大栈深度
+
+    // 语句下标 -> 起始 pc / 行号，出错时据此报告所在的行
+    std::vector<int> stmtStart;
+    std::vector<int> lines;
+
+    // pc 所在语句的下标 / 行号，没有对应语句时为 -1
+    int stmtAt(int pc) const;
+    int lineAt(int pc) const;
+};
+
+// === 编译器：把 Statement / Expression 树降级为字节码 ===
+// 语句必须已经 resolve 过，变量直接编译成 EvaluationContext 的槽位下标；
+// 程序必须已经 link 过，跳转目标直接取语句下标
+// countStatements 为 true 时在每个基本块入口生成 OP_COUNT，供执行预算统计语句条数：
+// 基本块从跳转目标或跳转 / END 之后的语句开始，进入后其中的语句必然全部执行
+class BytecodeCompiler {
+public:
+    BytecodeProgram compile(const Program &program, bool countStatements = false);
+
+private:
+    BytecodeProgram prog;
+    std::vector<int> pendingJumps;  // 需要回填跳转目标（目前存的是语句下标）的指令
+    int depth = 0;
+
+    void emit(OpCode op, int arg = 0);
+    void compileStatement(Statement *stmt);
+    void compileExpression(Expression *exp);
+};
+
+// === 栈式虚拟机 ===
+// context 有执行预算时，程序必须用 countStatements 编译，否则只能限制输出
+class VirtualMachine {
+public:
+    void run(const BytecodeProgram &prog, EvaluationContext &context);
+};
+
+#endif // BYTECODE_H
@@ -0,0 +1,174 @@
+#include "interpreter.h"
+#include "io.h"
+#include "session.h"
+#include "transpiler.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+// 命令行版本：不创建任何窗口，从文件读取程序，用标准输入输出运行后退出
+// 用法: minibasic-cli [--engine=vm|tree|jit|flat] [--time] [--profile] program.txt
+// --profile: 逐行统计执行次数和时间，结束后以 CSV 输出到标准错误
+// --max-statements=N / --max-time=MS / --max-output=LINES: 执行限制，超出时报告所在行并以 3 退出
+// --emit-cpp=FILE: 不运行，把程序翻译成 C++ 源文件（FILE 为 - 时写到标准输出），见 transpiler.h
+// --input=FILE: INPUT 依次读取文件中的值（每行一个），读完即报告输入结束，不再读标准输入
+// --record=FILE: 把这次运行的 INPUT 值、PRINT 输出和错误记录到会话文件，见 session.h
+// --replay=FILE: 用会话文件中的输入全速重新运行，输出与记录不一致时报告第一处不同并以 4 退出
+// --lazy: 每一行第一次执行到时才解析，语法错误在执行到那一行时报告（总是用树遍历执行）
+
+static void usage() {
+    std::fprintf(stderr, "usage: minibasic-cli [--engine=vm|tree|jit|flat] [--time] [--profile]\n"
+                         "                    [--max-statements=N] [--max-time=MS] [--max-output=LINES]\n"
+                         "                    [--emit-cpp=FILE] [--input=FILE] [--record=FILE] [--replay=FILE]\n"
+                         "                    [--lazy] program.txt\n");
+}
+
+int main(int argc, char *argv[])
+{
+    ExecEngine engine = ENGINE_BYTECODE;
+    bool showTime = false;
+    bool profile = false;
+    bool lazy = false;
+    ExecutionLimits limits;
+    const char *path = nullptr;
+    const char *cppPath = nullptr;
+    const char *inputPath = nullptr;
+    const char *recordPath = nullptr;
+    const char *replayPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--engine=vm") == 0) engine = ENGINE_BYTECODE;
+        else if (std::strcmp(argv[i], "--engine=tree") == 0) engine = ENGINE_TREE;
+        else if (std::strcmp(argv[i], "--engine=jit") == 0) engine = ENGINE_JIT;
+        else if (std::strcmp(argv[i], "--engine=flat") == 0) engine = ENGINE_FLAT;
+        else if (std::strcmp(argv[i], "--time") == 0) showTime = true;
+        else if (std::strcmp(argv[i], "--profile") == 0) profile = true;
+        else if (std::strcmp(argv[i], "--lazy") == 0) lazy = true;
+        else if (std::strncmp(argv[i], "--max-statements=", 17) == 0) limits.maxStatements = std::atoll(argv[i] + 17);
+        else if (std::strncmp(argv[i], "--max-time=", 11) == 0) limits.maxMillis = std::atoll(argv[i] + 11);
+        else if (std::strncmp(argv[i], "--max-output=", 13) == 0) limits.maxOutputLines = std::atoll(argv[i] + 13);
+        else if (std::strncmp(argv[i], "--emit-cpp=", 11) == 0) cppPath = argv[i] + 11;
+        else if (std::strncmp(argv[i], "--input=", 8) == 0) inputPath = argv[i] + 8;
+        else if (std::strncmp(argv[i], "--record=", 9) == 0) recordPath = argv[i] + 9;
+        else if (std::strncmp(argv[i], "--replay=", 9) == 0) replayPath = argv[i] + 9;
+        else if (argv[i][0] == '-') { usage(); return 2; }
+        else path = argv[i];
+    }
+    if (!path) { usage(); return 2; }
+    if (profile) engine = ENGINE_TREE; // 逐行分析总是用树遍历
+    if (cppPath) lazy = false;         // 翻译需要整段程序
+
+    StdoutSink output;
+    StdinSource input;
+    ScriptedInputSource scripted;
+    if (inputPath) {
+        std::ifstream in(inputPath, std::ios::binary);
+        if (!in) {
+            std::fprintf(stderr, "cannot open %s\n", inputPath);
+            return 2;
+        }
+        scripted.pushText(std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()));
+    }
+
+    // 记录时在输入输出端口外面各套一层
+    SessionLog session;
+    RecordingSink recordingOutput(&output, session);
+    RecordingInputSource recordingInput(inputPath ? (InputSource *)&scripted : &input, session);
+
+    EvaluationContext context;
+    if (recordPath) context.setIO(&recordingOutput, &recordingInput);
+    else context.setIO(&output, inputPath ? (InputSource *)&scripted : &input);
+    context.setLimits(limits);
+
+    Program program;
+    try {
+        if (lazy) parseProgramLazy(loadSourceFile(path), program);
+        else parseProgram(loadSourceFile(path), context, program);
+    }
+    catch (std::exception &e) {
+        std::fprintf(stderr, "Syntax Error: %s\n", e.what());
+        return 1;
+    }
+
+    if (cppPath) {
+        CppTranspiler transpiler;
+        std::string code = transpiler.translate(program);
+        bool toStdout = std::strcmp(cppPath, "-") == 0;
+        std::FILE *out = toStdout ? stdout : std::fopen(cppPath, "w");
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", cppPath);
+            return 1;
+        }
+        std::fwrite(code.data(), 1, code.size(), out);
+        if (!toStdout) std::fclose(out);
+        return 0;
+    }
+
+    if (replayPath) {
+        try {
+            ReplayResult result = replaySession(program, context, engine, SessionLog::load(replayPath), &output);
+            output.flush();
+            if (!result.matched) {
+                std::fprintf(stderr, "Replay mismatch at %s\n", result.mismatch.c_str());
+                return 4;
+            }
+            std::fprintf(stderr, "Replay matched: %d inputs, %d output lines\n", result.inputs, result.outputs);
+            return 0;
+        }
+        catch (std::exception &e) {
+            output.flush();
+            std::fprintf(stderr, "Replay Error: %s\n", e.what());
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int status = 0;
+    Profiler profiler;
+    try {
+        executeProgram(program, context, engine, profile ? &profiler : nullptr);
+    }
+    catch (LimitExceeded &e) {
+        output.flush();
+        std::fprintf(stderr, "Limit Error: %s\n", e.what());
+        session.addError(e.what());
+        status = 3;
+    }
+    catch (LazySyntaxError &e) {
+        output.flush();
+        std::fprintf(stderr, "Syntax Error: %s\n", e.what());
+        session.addError(e.what());
+        status = 1;
+    }
+    catch (std::exception &e) {
+        output.flush();
+        std::fprintf(stderr, "Runtime Error: %s\n", e.what());
+        session.addError(e.what());
+        status = 1;
+    }
+    output.flush();
+
+    if (recordPath) {
+        try {
+            session.save(recordPath);
+        }
+        catch (std::exception &e) {
+            std::fprintf(stderr, "%s\n", e.what());
+            if (status == 0) status = 1;
+        }
+    }
+
+    if (showTime) {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        const char *name = engine == ENGINE_BYTECODE ? "VM" : engine == ENGINE_JIT ? "JIT" : engine == ENGINE_FLAT ? "Flat" : "Tree";
+        std::fprintf(stderr, "%s: %.3f ms\n", name, ms);
+    }
+    if (profile) {
+        std::fputs(profiler.toCsv().c_str(), stderr);
+    }
+    return status;
+}
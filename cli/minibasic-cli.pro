@@ -0,0 +1,13 @@
+# 命令行版本：不链接 Qt，读取程序文件，用标准输入输出运行后退出
+# 用法: minibasic-cli [--engine=vm|tree] [--time] program.txt
+
+TEMPLATE = app
+TARGET = minibasic-cli
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(../core.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,50 @@
+# 解释器核心：不依赖 Qt，界面版 (MiniBasic.pro) 和命令行版 (cli/minibasic-cli.pro) 共用
+
+INCLUDEPATH += $$PWD
+
+# 并行解析、批量评测的线程池使用 std::thread
+CONFIG += thread
+
+SOURCES += \
+    $$PWD/arena.cpp \
+    $$PWD/budget.cpp \
+    $$PWD/bytecode.cpp \
+    $$PWD/expression.cpp \
+    $$PWD/flatast.cpp \
+    $$PWD/interpreter.cpp \
+    $$PWD/io.cpp \
+    $$PWD/jit.cpp \
+    $$PWD/optimizer.cpp \
+    $$PWD/parallelparse.cpp \
+    $$PWD/parsecache.cpp \
+    $$PWD/parser.cpp \
+    $$PWD/profiler.cpp \
+    $$PWD/program.cpp \
+    $$PWD/session.cpp \
+    $$PWD/statement.cpp \
+    $$PWD/threadpool.cpp \
+    $$PWD/tokenizer.cpp \
+    $$PWD/transpiler.cpp
+
+HEADERS += \
+    $$PWD/arena.h \
+    $$PWD/arith.h \
+    $$PWD/budget.h \
+    $$PWD/bytecode.h \
+    $$PWD/expression.h \
+    $$PWD/flatast.h \
+    $$PWD/interpreter.h \
+    $$PWD/io.h \
+    $$PWD/jit.h \
+    $$PWD/optimizer.h \
+    $$PWD/parallelparse.h \
+    $$PWD/parsecache.h \
+    $$PWD/parser.h \
+    $$PWD/profiler.h \
+    $$PWD/program.h \
+    $$PWD/session.h \
+    $$PWD/spscqueue.h \
+    $$PWD/statement.h \
+    $$PWD/threadpool.h \
+    $$PWD/tokenizer.h \
+    $$PWD/transpiler.h
@@ -1,8 +1,9 @@
 #include "expression.h"
-#include <cmath>    // std::pow
+#include "arith.h"  // basicDiv, basicMod, basicPow
 #include <string>
 #include <stdexcept> // std::runtime_error
 #include <sstream>
+#include <algorithm> // std::fill
 
 // 生成 n 个空格
 static std::string indentStr(int n) {
@@ -13,23 +14,36 @@ static std::string indentStr(int n) {
 // EvaluationContext (变量上下文) 实现
 // ==========================================================
 
-void EvaluationContext::setValue(std::string var, int value) {
-    symbolTable[var] = value;
+void EvaluationContext::setValue(const std::string &var, int value) {
+    setSlot(slotOf(var), value);
 }
 
-int EvaluationContext::getValue(std::string var) {
-    if (isDefined(var)) {
-        return symbolTable[var];
-    }
-    return 0; // BASIC 默认未初始化的变量为 0
+int EvaluationContext::getValue(const std::string &var) {
+    auto it = slotIndex.find(var);
+    if (it == slotIndex.end()) return 0; // BASIC 默认未初始化的变量为 0
+    return values[it->second];
 }
 
-bool EvaluationContext::isDefined(std::string var) {
-    return symbolTable.find(var) != symbolTable.end();
+bool EvaluationContext::isDefined(const std::string &var) {
+    auto it = slotIndex.find(var);
+    return it != slotIndex.end() && defined[it->second];
+}
+
+int EvaluationContext::slotOf(const std::string &var) {
+    auto it = slotIndex.find(var);
+    if (it != slotIndex.end()) return it->second;
+
+    int slot = (int)names.size();
+    slotIndex.emplace(var, slot);
+    names.push_back(var);
+    values.push_back(0);
+    defined.push_back(0);
+    return slot;
 }
 
 void EvaluationContext::clear() {
-    symbolTable.clear();
+    std::fill(values.begin(), values.end(), 0);
+    std::fill(defined.begin(), defined.end(), 0);
 }
 
 // ==========================================================
@@ -44,6 +58,8 @@ std::string Expression::getOperator() { return ""; }
 int Expression::getConstantValue() { return 0; }
 Expression* Expression::getLHS() { return nullptr; }
 Expression* Expression::getRHS() { return nullptr; }
+int Expression::getSlot() { return -1; }
+void Expression::resolve(EvaluationContext &) {}
 
 // ==========================================================
 // ConstantExp (常数) 实现
@@ -72,20 +88,24 @@ int ConstantExp::getConstantValue() {
 // IdentifierExp (变量) 实现
 // ==========================================================
 
-IdentifierExp::IdentifierExp(std::string name) : name(name) {}
+IdentifierExp::IdentifierExp(std::string_view name) : name(name) {}
 
 int IdentifierExp::eval(EvaluationContext &context) {
-    if (!context.isDefined(name)) {
-        // 可以在这里抛出异常，或者静默返回0 (符合Minimal Basic特性)
-        // throw std::runtime_error("Variable '" + name + "' is not defined");
-        return 0;
-    }
-    return context.getValue(name);
+    // 未赋值的槽位为 0 (符合Minimal Basic特性)
+    return context.getSlot(slot);
+}
+
+void IdentifierExp::resolve(EvaluationContext &context) {
+    slot = context.slotOf(std::string(name));
+}
+
+int IdentifierExp::getSlot() {
+    return slot;
 }
 
 std::string IdentifierExp::toString(int indent) {
     // 缩进 + 变量名 + 换行
-    return indentStr(indent) + name + "\n";
+    return indentStr(indent) + std::string(name) + "\n";
 }
 
 ExpressionType IdentifierExp::type() {
@@ -93,21 +113,16 @@ ExpressionType IdentifierExp::type() {
 }
 
 std::string IdentifierExp::getIdentifierName() {
-    return name;
+    return std::string(name);
 }
 
 // ==========================================================
 // CompoundExp (复合运算) 实现
 // ==========================================================
 
-CompoundExp::CompoundExp(std::string op, Expression *lhs, Expression *rhs)
+CompoundExp::CompoundExp(std::string_view op, Expression *lhs, Expression *rhs)
     : op(op), lhs(lhs), rhs(rhs) {}
 
-CompoundExp::~CompoundExp() {
-    delete lhs; // 递归删除左子树
-    delete rhs; // 递归删除右子树
-}
-
 int CompoundExp::eval(EvaluationContext &context) {
     int leftVal = lhs->eval(context);
     int rightVal = rhs->eval(context);
@@ -116,32 +131,35 @@ int CompoundExp::eval(EvaluationContext &context) {
     if (op == "-") return leftVal - rightVal;
     if (op == "*") return leftVal * rightVal;
 
-    if (op == "/") {
-        if (rightVal == 0) throw std::runtime_error("Division by zero");
-        return leftVal / rightVal;
-    }
+    if (op == "/") return basicDiv(leftVal, rightVal);
+    if (op == "MOD") return basicMod(leftVal, rightVal);
+    if (op == "**") return basicPow(leftVal, rightVal);
 
-    if (op == "MOD") {
-        if (rightVal == 0) throw std::runtime_error("Division by zero");
-        // 题目要求：r 的符号与 b (rightVal) 相同
-        int r = leftVal % rightVal;
-        if ((rightVal > 0 && r < 0) || (rightVal < 0 && r > 0)) {
-            r += rightVal;
-        }
-        return r;
-    }
+    throw std::runtime_error("Illegal operator: " + std::string(op));
+}
 
-    if (op == "**") {
-        return (int)std::pow(leftVal, rightVal);
-    }
+// 按右侧 / 左侧的种类选择特化形式
+template <typename Op>
+static CompoundExp *makeSpecialized(Arena &arena, std::string_view op, Expression *lhs, Expression *rhs) {
+    if (rhs->type() != CONSTANT) return arena.make<BinaryExp<Op>>(op, lhs, rhs);
+    if (lhs->type() == IDENTIFIER) return arena.make<VarConstExp<Op>>(op, lhs, rhs);
+    return arena.make<BinaryConstExp<Op>>(op, lhs, rhs);
+}
 
-    throw std::runtime_error("Illegal operator: " + op);
+CompoundExp *CompoundExp::make(Arena &arena, std::string_view op, Expression *lhs, Expression *rhs) {
+    if (op == "+") return makeSpecialized<AddOp>(arena, op, lhs, rhs);
+    if (op == "-") return makeSpecialized<SubOp>(arena, op, lhs, rhs);
+    if (op == "*") return makeSpecialized<MulOp>(arena, op, lhs, rhs);
+    if (op == "/") return makeSpecialized<DivOp>(arena, op, lhs, rhs);
+    if (op == "MOD") return makeSpecialized<ModOp>(arena, op, lhs, rhs);
+    if (op == "**") return makeSpecialized<PowOp>(arena, op, lhs, rhs);
+    return arena.make<CompoundExp>(op, lhs, rhs); // 不认识的运算符：求值时报错
 }
 
 std::string CompoundExp::toString(int indent) {
     std::string str;
     // 1. 打印操作符 (根)
-    str += indentStr(indent) + op + "\n";
+    str += indentStr(indent) + std::string(op) + "\n";
     // 2. 递归打印左子树 (缩进 + 4)
     str += lhs->toString(indent + 4);
     // 3. 递归打印右子树 (缩进 + 4)
@@ -153,8 +171,13 @@ ExpressionType CompoundExp::type() {
     return COMPOUND;
 }
 
+void CompoundExp::resolve(EvaluationContext &context) {
+    lhs->resolve(context);
+    rhs->resolve(context);
+}
+
 std::string CompoundExp::getOperator() {
-    return op;
+    return std::string(op);
 }
 
 Expression* CompoundExp::getLHS() {
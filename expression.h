@@ -2,51 +2,102 @@
 #define EXPRESSION_H
 
 #include <string>
+#include <string_view>
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include <stdexcept>
-#include <functional> // 【新增】用于 std::function
-
-// 【新增】引入 Qt 头文件，以便操作 UI
-#include <QTextBrowser>
-#include <QInputDialog>
+#include <atomic>
+#include "io.h"
+#include "budget.h"
+#include "arena.h"
+#include "arith.h"
+
+// 【新增】运行被外部请求停止（界面的 STOP）时抛出
+class ExecutionStopped : public std::runtime_error {
+public:
+    ExecutionStopped() : std::runtime_error("Program stopped") {}
+};
 
 
 //变量表
 class EvaluationContext {
 public:
-    // 定义一个函数类型，用于读取输入
-    // 它不接收参数，返回一个 int
-    using InputHandler = std::function<int()>;
-
-    // 设置 UI 和 输入处理器
-    void setUI(QTextBrowser *out, InputHandler handler) {
-        outputBrowser = out;
-        inputHandler = handler; // 保存这个“锦囊”函数
+    // 【修改】设置输入输出端口：界面、终端或批处理各自提供实现，
+    // 解释器核心不再依赖 Qt
+    void setIO(OutputSink *out, InputSource *in) {
+        output = out;
+        input = in;
+    }
+    OutputSink *outputSink() const { return output; }
+    InputSource *inputSource() const { return input; }
+
+    // 【新增】停止标志：由其他线程置位，执行引擎在每次跳转时检查，
+    // 任何死循环都必然跳转，因此能在很短时间内停下来
+    void setStopFlag(const std::atomic<bool> *flag) { stopFlag = flag; }
+    bool stopRequested() const {
+        return stopFlag && stopFlag->load(std::memory_order_relaxed);
     }
 
-    void setValue(std::string var, int value);
-    int getValue(std::string var);
-    bool isDefined(std::string var);
+    // 【新增】执行限制：保存在 context 中作为配置，executeProgram 每次运行据此建立 budget
+    void setLimits(const ExecutionLimits &l) { executionLimits = l; }
+    const ExecutionLimits &limits() const { return executionLimits; }
+    // 正在进行的运行的预算，没有限制时为 nullptr
+    void setBudget(ExecutionBudget *b) { activeBudget = b; }
+    ExecutionBudget *budget() const { return activeBudget; }
+
+    // 按名字访问变量（立即模式、调试等使用）
+    void setValue(const std::string &var, int value);
+    int getValue(const std::string &var);
+    bool isDefined(const std::string &var);
+
+    // 【新增】变量槽：每个变量名在第一次解析时分配一个稠密下标，
+    // 运行时 LET / INPUT / 变量读取直接访问 int 数组，不再查 map
+    int slotOf(const std::string &var); // 查找或分配槽位
+    const std::string &slotName(int slot) const { return names[slot]; }
+    int slotCount() const { return (int)names.size(); }
+    bool isSlotDefined(int slot) const { return defined[slot] != 0; }
+    int getSlot(int slot) const { return values[slot]; }
+    void setSlot(int slot, int value) {
+        values[slot] = value;
+        defined[slot] = 1;
+    }
+
+    // 【新增】原生代码（见 jit.h）按下标直接读写槽位数组和停止标志；
+    // 执行期间不会分配新槽位，每次进入原生代码前重新取指针即可
+    int *slotValues() { return values.data(); }
+    char *slotDefined() { return defined.data(); }
+    const std::atomic<bool> *stopFlagAddress() const { return stopFlag; }
+
+    // 清空变量的值；槽位分配保留，已解析的语句仍然有效
     void clear();
 
-    void writeOutput(std::string msg) {
-        if (outputBrowser) outputBrowser->append(QString::fromStdString(msg));
+    void writeOutput(const std::string &msg) {
+        if (activeBudget) activeBudget->countOutput();
+        if (output) output->writeLine(msg);
     }
 
-    // 【修改】现在的 readInput 变得非常简单，它只负责调用“锦囊”
-    int readInput(std::string varName) {
-        if (!inputHandler) throw std::runtime_error("No input handler defined");
-        // 这里会调用 MainWindow 里的那个复杂逻辑，并阻塞直到用户输入完毕
-        return inputHandler();
+    // 阻塞直到 InputSource 给出一个整数
+    int readInput(const std::string &varName) {
+        if (!input) throw std::runtime_error("No input handler defined");
+        return input->readInt(varName);
     }
 
 private:
-    std::map<std::string, int> symbolTable;
-    QTextBrowser *outputBrowser = nullptr;
-    InputHandler inputHandler = nullptr; // 【新增】存储外部传入的输入逻辑
+    std::unordered_map<std::string, int> slotIndex; // 变量名 -> 槽位
+    std::vector<std::string> names;   // 槽位 -> 变量名
+    std::vector<int> values;          // 槽位 -> 值（未赋值的变量为 0）
+    std::vector<char> defined;        // 槽位 -> 是否被赋过值
+    OutputSink *output = nullptr;
+    InputSource *input = nullptr;
+    const std::atomic<bool> *stopFlag = nullptr;
+    ExecutionLimits executionLimits;
+    ExecutionBudget *activeBudget = nullptr;
 };
 // === 2. 表达式基类 (Expression) ===
 // 所有的表达式节点（数字、变量、运算）都继承自它
+// 【修改】节点由 Parser 在 Arena 中分配，随 Arena 整体释放，不要 delete 单个节点；
+// 节点里的字符串也是指向 Arena（或静态常量）的 std::string_view
 enum ExpressionType { CONSTANT, IDENTIFIER, COMPOUND };
 
 class Expression {
@@ -64,10 +115,14 @@ public:
 
     virtual ExpressionType type() = 0;
 
+    // 【新增】符号解析：把变量名换成 context 中的槽位下标
+    virtual void resolve(EvaluationContext &context);
+
     // 获取优先级的辅助函数（为后续 Parser 准备）
     // 例如 * 比 + 优先级高
     virtual int getConstantValue(); // 仅用于 ConstantExp
     virtual std::string getIdentifierName(); // 仅用于 IdentifierExp
+    virtual int getSlot(); // 仅用于 IdentifierExp，解析前为 -1
     virtual std::string getOperator(); // 仅用于 CompoundExp
     virtual Expression *getLHS();
     virtual Expression *getRHS();
@@ -90,34 +145,102 @@ private:
 // === 4. 变量表达式 (例如: A) ===
 class IdentifierExp : public Expression {
 public:
-    IdentifierExp(std::string name);
+    IdentifierExp(std::string_view name);
 
     virtual int eval(EvaluationContext &context) override;
     virtual std::string toString(int indent = 0) override;
     virtual ExpressionType type() override;
     virtual std::string getIdentifierName() override;
+    virtual void resolve(EvaluationContext &context) override;
+    virtual int getSlot() override;
 
 private:
-    std::string name;
+    std::string_view name;
+    int slot = -1;
 };
 
 // === 5. 复合表达式 (例如: A + 10) ===   表达式树的节点
+// 【修改】CompoundExp::eval 每次按运算符名字比较字符串，只用于常量折叠等一次性求值；
+// Parser / Optimizer 通过 CompoundExp::make 创建按运算符特化的子类（见下面的 BinaryExp），
+// 它们的 eval 只有一次内联的运算。对外仍然都是 COMPOUND，访问器不变
 class CompoundExp : public Expression {
 public:
-    CompoundExp(std::string op, Expression *lhs, Expression *rhs);
-    virtual ~CompoundExp();
+    CompoundExp(std::string_view op, Expression *lhs, Expression *rhs);
+
+    // 【新增】在 arena 中创建 op 对应的特化节点；右侧是常数时用常数操作数的形式，
+    // 左侧同时是变量时用 变量 op 常数 的形式（例如 I + 1、A * 3）
+    static CompoundExp *make(Arena &arena, std::string_view op, Expression *lhs, Expression *rhs);
 
     virtual int eval(EvaluationContext &context) override;
     virtual std::string toString(int indent = 0) override;
     virtual ExpressionType type() override;
+    virtual void resolve(EvaluationContext &context) override;
     virtual std::string getOperator() override;
     virtual Expression *getLHS() override;
     virtual Expression *getRHS() override;
 
-private:
-    std::string op;   // 运算符: +, -, *, /, MOD, **
+    // 不拷贝的运算符名（指向静态常量）
+    std::string_view getOperatorName() const { return op; }
+
+protected:
+    std::string_view op; // 运算符: +, -, *, /, MOD, **
     Expression *lhs;  // 左子树 (Left Hand Side)
     Expression *rhs;  // 右子树 (Right Hand Side)
 };
 
+// === 6. 按运算符特化的复合表达式 ===
+// 运算符用标签类型表示，apply 与 arith.h 中的定义一致
+struct AddOp { static int apply(int l, int r) { return l + r; } };
+struct SubOp { static int apply(int l, int r) { return l - r; } };
+struct MulOp { static int apply(int l, int r) { return l * r; } };
+struct DivOp { static int apply(int l, int r) { return basicDiv(l, r); } };
+struct ModOp { static int apply(int l, int r) { return basicMod(l, r); } };
+struct PowOp { static int apply(int l, int r) { return basicPow(l, r); } };
+
+// 一般形式：左右都是任意子树
+template <typename Op>
+class BinaryExp : public CompoundExp {
+public:
+    using CompoundExp::CompoundExp;
+
+    virtual int eval(EvaluationContext &context) override {
+        int leftVal = lhs->eval(context); // 先左后右
+        return Op::apply(leftVal, rhs->eval(context));
+    }
+};
+
+// 右侧是常数：常数直接存在节点里，不再调用右子树的 eval
+template <typename Op>
+class BinaryConstExp : public CompoundExp {
+public:
+    BinaryConstExp(std::string_view op, Expression *lhs, Expression *rhs)
+        : CompoundExp(op, lhs, rhs), constant(rhs->getConstantValue()) {}
+
+    virtual int eval(EvaluationContext &context) override {
+        return Op::apply(lhs->eval(context), constant);
+    }
+
+protected:
+    int constant;
+};
+
+// 变量 op 常数：两个操作数都就地取得，没有子节点调用
+template <typename Op>
+class VarConstExp : public BinaryConstExp<Op> {
+public:
+    using BinaryConstExp<Op>::BinaryConstExp;
+
+    virtual int eval(EvaluationContext &context) override {
+        return Op::apply(context.getSlot(slot), this->constant);
+    }
+
+    virtual void resolve(EvaluationContext &context) override {
+        CompoundExp::resolve(context);
+        slot = this->lhs->getSlot();
+    }
+
+private:
+    int slot = -1;
+};
+
 #endif // EXPRESSION_H
@@ -0,0 +1,210 @@
+#include "flatast.h"
+#include "arith.h"
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+// ==========================================================
+// 转换
+// ==========================================================
+
+void FlatProgram::compile(const Program &program) {
+    nodes.clear();
+    stmts.clear();
+    lines.clear();
+    maxDepth = 0;
+    stmts.reserve(program.size());
+    lines.reserve(program.size());
+
+    for (int i = 0; i < program.size(); i++) {
+        Statement *stmt = program.at(i);
+        FlatStatement s{stmt->type(), 0, -1, (int)nodes.size(), -1, -1, -1};
+        switch (s.kind) {
+        case LET_STMT:
+            s.slot = stmt->getSlot();
+            s.exp = append(stmt->getExp());
+            break;
+        case PRINT_STMT:
+            s.exp = append(stmt->getExp());
+            break;
+        case INPUT_STMT:
+            s.slot = stmt->getSlot();
+            break;
+        case GOTO_STMT:
+            s.target = stmt->getTarget();
+            break;
+        case IF_STMT: {
+            s.exp = append(stmt->getLHS());
+            s.exp2 = append(stmt->getRHS());
+            s.target = stmt->getTarget();
+            std::string op = stmt->getOperator();
+            if (op == "=" || op == "<" || op == ">") s.cmp = op[0];
+            break;
+        }
+        default:
+            break;
+        }
+        if (s.exp >= 0) maxDepth = std::max(maxDepth, depthOf(s.begin, s.exp));
+        if (s.exp2 >= 0) maxDepth = std::max(maxDepth, depthOf(s.exp + 1, s.exp2));
+        stmts.push_back(s);
+        lines.push_back(program.lineAt(i));
+    }
+}
+
+int FlatProgram::append(Expression *exp) {
+    switch (exp->type()) {
+    case CONSTANT:
+        nodes.push_back({FLAT_CONST, exp->getConstantValue()});
+        break;
+
+    case IDENTIFIER:
+        nodes.push_back({FLAT_LOAD, exp->getSlot()});
+        break;
+
+    case COMPOUND: {
+        // 后序：先放左右子树，父节点紧跟在右子树的根之后
+        append(exp->getLHS());
+        append(exp->getRHS());
+
+        std::string op = exp->getOperator();
+        FlatOp kind;
+        if (op == "+") kind = FLAT_ADD;
+        else if (op == "-") kind = FLAT_SUB;
+        else if (op == "*") kind = FLAT_MUL;
+        else if (op == "/") kind = FLAT_DIV;
+        else if (op == "MOD") kind = FLAT_MOD;
+        else if (op == "**") kind = FLAT_POW;
+        else throw std::runtime_error("Illegal operator: " + op);
+        nodes.push_back({kind, 0});
+        break;
+    }
+    }
+    return (int)nodes.size() - 1;
+}
+
+// ==========================================================
+// 执行
+// ==========================================================
+
+// 值栈在 [first, last] 这段节点上的最大深度
+int FlatProgram::depthOf(int first, int last) const {
+    int depth = 0, most = 0;
+    for (int i = first; i <= last; i++) {
+        if (nodes[i].op == FLAT_CONST || nodes[i].op == FLAT_LOAD) most = std::max(most, ++depth);
+        else depth--;
+    }
+    return most;
+}
+
+static inline int leaf(const FlatNode &n, const int *values) {
+    return n.op == FLAT_CONST ? n.a : values[n.a];
+}
+
+static inline int apply(FlatOp op, int l, int r) {
+    switch (op) {
+    case FLAT_ADD: return l + r;
+    case FLAT_SUB: return l - r;
+    case FLAT_MUL: return l * r;
+    case FLAT_DIV: return basicDiv(l, r);
+    case FLAT_MOD: return basicMod(l, r);
+    default: return basicPow(l, r);
+    }
+}
+
+// 至少三个节点（根是运算节点）
+int FlatProgram::eval(int first, int last, const int *values, int *stack) const {
+    const FlatNode *n = nodes.data() + first;
+    // 三个节点时后序只能是 叶子 叶子 运算（I + 1 这类最常见的形状），直接算
+    if (last == first + 2) return apply(n[2].op, leaf(n[0], values), leaf(n[1], values));
+
+    // 先左后右再运算，与 CompoundExp::eval 的求值顺序一致。
+    // 栈顶放在 top 里，不写回内存：叶子把旧的栈顶压下去，运算节点和次栈顶运算
+    const FlatNode *end = nodes.data() + last + 1;
+    int top = leaf(*n, values); // 后序的第一个节点总是叶子
+    int *sp = stack;
+    for (++n; n != end; ++n) {
+        switch (n->op) {
+        case FLAT_CONST: *sp++ = top; top = n->a; break;
+        case FLAT_LOAD: *sp++ = top; top = values[n->a]; break;
+        case FLAT_ADD: top = *--sp + top; break;
+        case FLAT_SUB: top = *--sp - top; break;
+        case FLAT_MUL: top = *--sp * top; break;
+        case FLAT_DIV: --sp; top = basicDiv(*sp, top); break;
+        case FLAT_MOD: --sp; top = basicMod(*sp, top); break;
+        case FLAT_POW: --sp; top = basicPow(*sp, top); break;
+        }
+    }
+    return top;
+}
+
+// 单个常数 / 变量（IF 两侧、LET X = Y 等）就地取值，不调用 eval
+inline int FlatProgram::value(int first, int last, const int *values, int *stack) const {
+    return first == last ? leaf(nodes[first], values) : eval(first, last, values, stack);
+}
+
+long long FlatProgram::run(EvaluationContext &context) const {
+    int pc = 0;
+    int n = (int)stmts.size();
+    long long executed = 0;
+
+    // 执行期间不会分配新槽位，数组不会移动（与 JIT 相同），LET 直接写槽位数组
+    int *values = context.slotValues();
+    char *defined = context.slotDefined();
+    std::vector<int> valueStack(std::max(maxDepth, 1));
+    int *stack = valueStack.data();
+
+    ExecutionBudget *budget = context.budget();
+    long long checkpoint = budget ? budget->checkpoint() : LLONG_MAX;
+
+    try {
+        while (pc < n) {
+            if (executed >= checkpoint) {
+                budget->check(executed, 1);
+                checkpoint = budget->checkpoint();
+            }
+
+            const FlatStatement &s = stmts[pc];
+            int next = Statement::NEXT_PC;
+            switch (s.kind) {
+            case REM_STMT:
+                break;
+            case LET_STMT:
+                values[s.slot] = value(s.begin, s.exp, values, stack);
+                defined[s.slot] = 1;
+                break;
+            case PRINT_STMT:
+                context.writeOutput(std::to_string(value(s.begin, s.exp, values, stack)));
+                break;
+            case INPUT_STMT:
+                context.setSlot(s.slot, context.readInput(context.slotName(s.slot)));
+                break;
+            case GOTO_STMT:
+                next = s.target;
+                break;
+            case IF_STMT: {
+                int l = value(s.begin, s.exp, values, stack);
+                int r = value(s.exp + 1, s.exp2, values, stack);
+                bool taken = s.cmp == '=' ? l == r : s.cmp == '<' ? l < r : s.cmp == '>' ? l > r : false;
+                if (taken) next = s.target;
+                break;
+            }
+            case END_STMT:
+                next = Statement::HALT_PC;
+                break;
+            }
+            executed++;
+
+            if (next == Statement::NEXT_PC) pc++;
+            else if (next == Statement::HALT_PC) break;
+            else {
+                pc = next;
+                if (context.stopRequested()) throw ExecutionStopped();
+            }
+        }
+    }
+    catch (LimitExceeded &e) {
+        e.setPosition(lines[pc], executed);
+        throw;
+    }
+    return executed;
+}
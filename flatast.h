@@ -0,0 +1,72 @@
+#ifndef FLATAST_H
+#define FLATAST_H
+
+#include "expression.h"
+#include "statement.h"
+#include "program.h"
+#include <vector>
+
+// === 扁平语法树 ===
+// 另一种表达式存储：整个程序的表达式节点按后序排在一个连续数组里，子树总是在父节点之前、
+// 彼此相邻，一个表达式占据以根节点结尾的一段连续下标。
+// 每个节点 8 字节（1 字节种类 + 一个 32 位字段），没有虚表、指针和字符串，
+// 而 Arena 中的 CompoundExp / IdentifierExp / ConstantExp 分别占 40 / 32 / 16 字节。
+// 求值不递归：从头到尾顺序扫一遍这段节点，叶子压栈，运算节点弹出两个值、压入结果
+// （后序就是先左后右再运算，与树遍历的求值顺序、报错完全一致）。按种类 switch，不调用虚函数，
+// 变量直接从槽位数组读取；单个叶子和 "叶子 运算 叶子" 这两种最常见的形状不进入循环。
+
+enum FlatOp : unsigned char {
+    FLAT_CONST,  // a = 常数
+    FLAT_LOAD,   // a = 变量槽
+    FLAT_ADD,    // 运算节点不用 a：两个操作数已经在值栈顶
+    FLAT_SUB,
+    FLAT_MUL,
+    FLAT_DIV,
+    FLAT_MOD,
+    FLAT_POW
+};
+
+struct FlatNode {
+    FlatOp op;
+    int a;
+};
+
+// 一条语句：表达式以根节点下标引用，没有的字段为 -1。
+// exp 的节点是 [begin, exp]；IF 右侧紧接在左侧之后，是 [exp + 1, exp2]
+struct FlatStatement {
+    StatementType kind;
+    char cmp;     // IF 的比较符 '=' / '<' / '>'，不认识的比较符为 0（条件永不成立）
+    int slot;     // LET / INPUT 的变量槽
+    int begin;    // exp 的第一个节点
+    int exp;      // LET / PRINT 的表达式，IF 左侧
+    int exp2;     // IF 右侧
+    int target;   // GOTO / IF 跳转目标的语句下标
+};
+
+// 把已经 resolve、link（并可选优化）过的 Program 转成扁平表示后执行；
+// 执行用的是语句的 getExp / getLHS / getRHS，即优化后的树。
+// 通常不直接构造，而是用 Program::flat()：转换一次，缓存到程序改变为止
+class FlatProgram {
+public:
+    void compile(const Program &program);
+
+    // 与 Program::run 相同的语义：跳转时检查停止标志，按 context 的预算计数，返回执行的语句条数
+    long long run(EvaluationContext &context) const;
+
+    int nodeCount() const { return (int)nodes.size(); }
+    size_t nodeBytes() const { return nodes.size() * sizeof(FlatNode); }
+
+private:
+    std::vector<FlatNode> nodes;
+    std::vector<FlatStatement> stmts;
+    std::vector<int> lines;
+    int maxDepth = 0; // 求值时值栈的最大深度
+
+    int append(Expression *exp); // 返回根节点下标
+    int depthOf(int first, int last) const;
+    // 求 [first, last] 这段节点表示的表达式；stack 至少有 maxDepth 个元素
+    int eval(int first, int last, const int *values, int *stack) const;
+    int value(int first, int last, const int *values, int *stack) const;
+};
+
+#endif // FLATAST_H
@@ -0,0 +1,13 @@
+# 批量评测：并行运行一个目录里的所有程序，与期望输出比较，输出通过 / 失败和耗时报告
+# 用法: grade [--jobs N] [--engine=vm|tree|jit] [--max-time MS] [--max-statements N] [--csv FILE] DIR
+
+TEMPLATE = app
+TARGET = grade
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(../core.pri)
+
+SOURCES += \
+    main.cpp
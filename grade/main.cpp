@@ -0,0 +1,265 @@
+#include "interpreter.h"
+#include "io.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// 批量评测：目录中的每个 NAME.txt 是一个程序，NAME.in 是它的输入（可选），NAME.out 是期望输出。
+// 每个程序在线程池中独立解析和运行（各自的 EvaluationContext / 输入 / 输出），互不共享状态。
+// 实际输出 = PRINT 的各行，出错时再加一行与命令行版本相同的 "Syntax Error: ..." / "Runtime Error: ..." /
+// "Limit Error: ..."；与期望输出逐行比较（忽略行尾空白和末尾空行）。
+// 用法: grade [--jobs N] [--engine=vm|tree|jit|flat] [--max-time MS] [--max-statements N] [--max-output LINES] [--csv FILE] DIR
+// 回归用例在 grade/regression 中，grade/regression/run.sh 用每个执行引擎各评测一遍，
+// grade/regression/transpile.sh 用同样的用例检查 --emit-cpp 翻译出的程序
+// --max-time 默认 10000 ms，防止死循环拖住整批评测；为 0 时不限制。
+// JIT 生成的机器码不计时也不计数，有任何限制时 --engine=jit 实际用树遍历执行（启动时在 stderr 提示）；
+// 要评测 JIT 本身，需同时传 --max-time 0，且不设 --max-statements / --max-output
+
+struct GradeCase {
+    std::string name;
+    std::string programPath;
+    std::string inputPath;     // 不存在时为空
+    std::string expectedPath;  // 不存在时为空
+    long long size = 0;        // 程序文件大小，用来决定提交顺序
+};
+
+struct GradeResult {
+    std::string status;        // PASS / FAIL / NO-EXPECTED
+    std::string detail;        // 第一处不同，或者出错信息
+    double ms = 0;             // 解析 + 运行
+};
+
+static bool fileSize(const std::string &path, long long &size) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    size = (long long)st.st_size;
+    return true;
+}
+
+static std::string readFile(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open " + path);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// 按行拆分，去掉行尾空白（包括 \r）和末尾的空行
+static std::vector<std::string> normalizedLines(const std::string &text) {
+    std::vector<std::string> lines;
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string::npos) end = text.size();
+        std::string line = text.substr(begin, end - begin);
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        lines.push_back(line);
+        begin = end + 1;
+    }
+    while (!lines.empty() && lines.back().empty()) lines.pop_back();
+    return lines;
+}
+
+static std::vector<GradeCase> findCases(const std::string &dir) {
+    DIR *d = opendir(dir.c_str());
+    if (!d) throw std::runtime_error("Cannot open directory " + dir);
+    std::vector<std::string> names;
+    while (dirent *entry = readdir(d)) {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0) names.push_back(name.substr(0, name.size() - 4));
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());
+
+    std::vector<GradeCase> cases;
+    for (const std::string &name : names) {
+        GradeCase c;
+        c.name = name;
+        c.programPath = dir + "/" + name + ".txt";
+        long long ignored;
+        if (fileSize(dir + "/" + name + ".in", ignored)) c.inputPath = dir + "/" + name + ".in";
+        if (fileSize(dir + "/" + name + ".out", ignored)) c.expectedPath = dir + "/" + name + ".out";
+        fileSize(c.programPath, c.size);
+        cases.push_back(c);
+    }
+    return cases;
+}
+
+// 在工作线程中调用：所有状态都是局部的
+static GradeResult grade(const GradeCase &c, ExecEngine engine, const ExecutionLimits &limits) {
+    GradeResult r;
+    auto start = std::chrono::steady_clock::now();
+
+    CollectingSink output;
+    std::vector<std::string> actual;
+    try {
+        ScriptedInputSource input;
+        if (!c.inputPath.empty()) input.pushText(readFile(c.inputPath));
+        EvaluationContext context;
+        context.setIO(&output, &input);
+        context.setLimits(limits);
+
+        Program program;
+        try {
+            // 各个程序已经在线程池里并行评测，单个程序不再开解析线程，免得线程数超过核数
+            parseProgram(loadSourceFile(c.programPath), context, program, 1);
+        }
+        catch (std::exception &e) {
+            throw std::runtime_error(std::string("Syntax Error: ") + e.what());
+        }
+        try {
+            executeProgram(program, context, engine);
+        }
+        catch (LimitExceeded &e) {
+            throw std::runtime_error(std::string("Limit Error: ") + e.what());
+        }
+        catch (std::exception &e) {
+            throw std::runtime_error(std::string("Runtime Error: ") + e.what());
+        }
+        actual = std::move(output.lines);
+    }
+    catch (std::exception &e) {
+        actual = std::move(output.lines);
+        actual.push_back(e.what());
+        r.detail = e.what();
+    }
+    r.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (c.expectedPath.empty()) {
+        r.status = "NO-EXPECTED";
+        return r;
+    }
+
+    std::vector<std::string> expected = normalizedLines(readFile(c.expectedPath));
+    for (std::string &line : actual) line.erase(line.find_last_not_of(" \t\r") + 1);
+    while (!actual.empty() && actual.back().empty()) actual.pop_back();
+
+    r.status = actual == expected ? "PASS" : "FAIL";
+    if (r.status == "FAIL") {
+        size_t i = 0;
+        while (i < actual.size() && i < expected.size() && actual[i] == expected[i]) i++;
+        std::string want = i < expected.size() ? "\"" + expected[i] + "\"" : "end of output";
+        std::string got = i < actual.size() ? "\"" + actual[i] + "\"" : "end of output";
+        r.detail = "line " + std::to_string(i + 1) + ": expected " + want + ", got " + got;
+    }
+    return r;
+}
+
+static std::string csvField(const std::string &s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static void usage() {
+    std::fprintf(stderr, "usage: grade [--jobs N] [--engine=vm|tree|jit|flat] [--max-time MS] [--max-statements N]\n"
+                         "             [--max-output LINES] [--csv FILE] DIR\n"
+                         "--max-time defaults to 10000; 0 means no limit.\n"
+                         "--engine=jit runs on the tree walker while any limit is set (use --max-time 0).\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int jobs = 0;
+    ExecEngine engine = ENGINE_BYTECODE;
+    ExecutionLimits limits;
+    limits.maxMillis = 10000; // 死循环的程序不能拖住整批评测
+    const char *csvPath = nullptr;
+    const char *dir = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--jobs") == 0 && hasValue) jobs = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--engine=vm") == 0) engine = ENGINE_BYTECODE;
+        else if (std::strcmp(argv[i], "--engine=tree") == 0) engine = ENGINE_TREE;
+        else if (std::strcmp(argv[i], "--engine=jit") == 0) engine = ENGINE_JIT;
+        else if (std::strcmp(argv[i], "--engine=flat") == 0) engine = ENGINE_FLAT;
+        else if (std::strcmp(argv[i], "--max-time") == 0 && hasValue) limits.maxMillis = std::atoll(argv[++i]);
+        else if (std::strcmp(argv[i], "--max-statements") == 0 && hasValue) limits.maxStatements = std::atoll(argv[++i]);
+        else if (std::strcmp(argv[i], "--max-output") == 0 && hasValue) limits.maxOutputLines = std::atoll(argv[++i]);
+        else if (std::strcmp(argv[i], "--csv") == 0 && hasValue) csvPath = argv[++i];
+        else if (argv[i][0] == '-') { usage(); return 2; }
+        else dir = argv[i];
+    }
+    if (!dir) { usage(); return 2; }
+    if (engine == ENGINE_JIT && limits.any()) {
+        std::fprintf(stderr, "note: execution limits are set, --engine=jit falls back to the tree walker"
+                             " (pass --max-time 0 and no other limits to run JIT code)\n");
+    }
+
+    std::vector<GradeCase> cases;
+    try {
+        cases = findCases(dir);
+    }
+    catch (std::exception &e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+
+    // 大的程序先提交，减少最后只剩一个长任务在跑的情况
+    std::vector<size_t> order(cases.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return cases[a].size > cases[b].size; });
+
+    std::vector<GradeResult> results(cases.size());
+    auto start = std::chrono::steady_clock::now();
+    int threads;
+    {
+        WorkStealingPool pool(jobs);
+        threads = pool.size();
+        for (size_t i : order) {
+            pool.submit([&, i]() {
+                try {
+                    results[i] = grade(cases[i], engine, limits);
+                }
+                catch (std::exception &e) { // 期望输出读不出来等
+                    results[i].status = "FAIL";
+                    results[i].detail = e.what();
+                }
+            });
+        }
+        pool.wait();
+    }
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    int passed = 0, failed = 0, missing = 0;
+    double caseMs = 0;
+    size_t width = 8;
+    for (const GradeCase &c : cases) width = std::max(width, c.name.size());
+    for (size_t i = 0; i < cases.size(); i++) {
+        const GradeResult &r = results[i];
+        if (r.status == "PASS") passed++;
+        else if (r.status == "FAIL") failed++;
+        else missing++;
+        caseMs += r.ms;
+        std::printf("%-*s %-11s %10.3f ms  %s\n", (int)width, cases[i].name.c_str(), r.status.c_str(), r.ms, r.detail.c_str());
+    }
+    std::printf("%zu cases: %d passed, %d failed, %d without expected output\n", cases.size(), passed, failed, missing);
+    std::printf("wall %.1f ms, sum of cases %.1f ms (%.2fx on %d threads)\n",
+                wallMs, caseMs, wallMs > 0 ? caseMs / wallMs : 0, threads);
+
+    if (csvPath) {
+        std::FILE *out = std::fopen(csvPath, "w");
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", csvPath);
+            return 2;
+        }
+        std::fprintf(out, "name,status,ms,detail\n");
+        for (size_t i = 0; i < cases.size(); i++) {
+            std::fprintf(out, "%s,%s,%.3f,%s\n", csvField(cases[i].name).c_str(), results[i].status.c_str(),
+                         results[i].ms, csvField(results[i].detail).c_str());
+        }
+        std::fclose(out);
+    }
+    return failed > 0 ? 1 : 0;
+}
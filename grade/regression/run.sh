@@ -0,0 +1,16 @@
+#!/bin/sh
+# 回归用例：用每个执行引擎各评测一遍，任何引擎有用例失败时以 1 退出
+#   本目录           不限制（--max-time 0，否则 --engine=jit 会退回树遍历）
+#   statements/      --max-statements 5（预算在基本块中间用完）
+#   output/          --max-output 3
+# 用法: grade/regression/run.sh path/to/grade
+GRADE=${1:-grade}
+DIR=$(dirname "$0")
+status=0
+for engine in tree vm jit flat; do
+    echo "== $engine"
+    "$GRADE" --engine=$engine --max-time 0 "$DIR" || status=1
+    "$GRADE" --engine=$engine --max-statements 5 "$DIR/statements" || status=1
+    "$GRADE" --engine=$engine --max-output 3 "$DIR/output" || status=1
+done
+exit $status
@@ -0,0 +1,31 @@
+#!/bin/sh
+# 翻译器的差分检查：本目录的每个用例用 --emit-cpp 翻译成 C++，以 -Wall -Wextra -Werror 编译后运行，
+# 输出（含 "Runtime Error: ..." 一行）必须与 NAME.out（树遍历的结果）完全相同。
+# 翻译器的运算函数是 arith.h 的手写副本，这里保证两边没有走样。
+# 用法: grade/regression/transpile.sh path/to/minibasic-cli [C++ 编译器，默认 c++]
+CLI=${1:-minibasic-cli}
+CXX=${2:-c++}
+DIR=$(dirname "$0")
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+status=0
+for program in "$DIR"/*.txt; do
+    name=$(basename "$program" .txt)
+    input="$DIR/$name.in"
+    [ -f "$input" ] || input=/dev/null
+    if ! "$CLI" --emit-cpp="$TMP/$name.cpp" "$program" ||
+       ! "$CXX" -std=c++17 -O2 -Wall -Wextra -Werror -o "$TMP/$name" "$TMP/$name.cpp"; then
+        echo "$name: cannot translate or compile"
+        status=1
+        continue
+    fi
+    "$TMP/$name" < "$input" > "$TMP/$name.actual" 2>&1
+    if cmp -s "$TMP/$name.actual" "$DIR/$name.out"; then
+        echo "$name: PASS"
+    else
+        echo "$name: FAIL"
+        diff "$DIR/$name.out" "$TMP/$name.actual" | head -5
+        status=1
+    fi
+done
+exit $status
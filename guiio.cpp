@@ -0,0 +1,40 @@
+#include "guiio.h"
+
+TextBrowserSink::TextBrowserSink(QTextBrowser *browser) : browser(browser) {
+    timer.setSingleShot(true);
+    timer.setInterval(MAX_DELAY_MS);
+    QObject::connect(&timer, &QTimer::timeout, [this]() { flush(); });
+}
+
+void TextBrowserSink::writeLine(const std::string &line) {
+    if (pendingLines > 0) pending += '\n';
+    pending += QString::fromUtf8(line.data(), (int)line.size());
+    pendingLines++;
+
+    if (pendingLines == 1) {
+        age.start();
+        timer.start();
+    }
+
+    // 读时钟也有开销，每 256 行才检查一次是否超时
+    if (pendingLines >= MAX_LINES ||
+        ((pendingLines & 255) == 0 && age.elapsed() >= MAX_DELAY_MS)) {
+        flush();
+    }
+}
+
+void TextBrowserSink::flush() {
+    if (pendingLines == 0) return;
+
+    timer.stop();
+    // 一次 append 整批文本，'\n' 会被拆成多个段落，显示效果与逐行 append 相同
+    browser->append(pending);
+    pending.clear();
+    pendingLines = 0;
+}
+
+void TextBrowserSink::discard() {
+    timer.stop();
+    pending.clear();
+    pendingLines = 0;
+}
@@ -0,0 +1,35 @@
+#ifndef GUIIO_H
+#define GUIIO_H
+
+#include "io.h"
+#include <QTextBrowser>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// 界面版输出：PRINT 结果先攒在缓冲区里，再成批追加到 QTextBrowser。
+// 每次 append 都会让控件重新排版，逐行追加在大量输出时会卡死界面。
+// 以下时机会刷新：
+//   - 缓冲区攒够 MAX_LINES 行，或距离第一行未刷新的输出超过 MAX_DELAY_MS
+//   - 事件循环空闲时由定时器触发（例如等待 INPUT 时）
+//   - 调用者显式 flush()：程序结束、显示 INPUT 提示或错误信息之前
+class TextBrowserSink : public OutputSink {
+public:
+    TextBrowserSink(QTextBrowser *browser);
+    virtual void writeLine(const std::string &line) override;
+    virtual void flush() override;
+
+    // 丢弃尚未刷新的输出（清空输出窗口时使用）
+    void discard();
+
+private:
+    static const int MAX_LINES = 8192;
+    static const int MAX_DELAY_MS = 100;
+
+    QTextBrowser *browser;
+    QString pending;       // 尚未刷新的输出，行之间用 '\n' 分隔
+    int pendingLines = 0;
+    QTimer timer;          // 单次定时器，事件循环空闲时刷新
+    QElapsedTimer age;     // 第一行未刷新输出的时间
+};
+
+#endif // GUIIO_H
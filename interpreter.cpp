@@ -0,0 +1,196 @@
+#include "interpreter.h"
+#include "parser.h"
+#include "parallelparse.h"
+#include "jit.h"
+#include "flatast.h"
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+static std::string trim(const std::string &s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+bool splitSourceLine(const std::string &line, int &lineNumber, std::string &code) {
+    std::string text = trim(line);
+    size_t space = text.find(' ');
+    std::string firstToken = text.substr(0, space);
+
+    bool isNumber;
+    lineNumber = parseIntLine(firstToken, isNumber);
+    if (!isNumber) return false;
+
+    code = space == std::string::npos ? "" : trim(text.substr(space));
+    return true;
+}
+
+// 跳过首尾空白（与 trim 相同的字符集）
+static std::string_view trimView(std::string_view s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string_view::npos) return std::string_view();
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+// 整个 token 必须是一个 int 范围内的整数（可带正负号）
+static bool parseLineNumberView(std::string_view token, int &value) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < token.size() && (token[i] == '+' || token[i] == '-')) negative = token[i++] == '-';
+    if (i == token.size()) return false;
+
+    long long v = 0;
+    for (; i < token.size(); i++) {
+        char c = token[i];
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + (c - '0');
+        if (v > 2147483648LL) return false;
+    }
+    if (negative) v = -v;
+    if (v < INT_MIN || v > INT_MAX) return false;
+    value = (int)v;
+    return true;
+}
+
+std::vector<SourceLine> scanSource(std::string_view text) {
+    // UTF-8 BOM
+    if (text.substr(0, 3) == "\xEF\xBB\xBF") text.remove_prefix(3);
+
+    std::vector<SourceLine> lines;
+    bool sorted = true;
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string_view::npos) eol = text.size();
+        std::string_view line = trimView(text.substr(pos, eol - pos));
+        pos = eol + 1;
+
+        size_t space = line.find(' ');
+        int lineNumber;
+        if (!parseLineNumberView(line.substr(0, space), lineNumber)) continue;
+        std::string_view code = space == std::string_view::npos ? std::string_view() : trimView(line.substr(space));
+        if (code.empty()) continue;
+
+        if (!lines.empty() && lineNumber <= lines.back().lineNumber) sorted = false;
+        lines.push_back({lineNumber, code});
+    }
+
+    if (!sorted) {
+        // 稳定排序后，每组相同行号只留最后一条（与逐行写入 map 的结果一致）
+        std::stable_sort(lines.begin(), lines.end(), [](const SourceLine &a, const SourceLine &b) {
+            return a.lineNumber < b.lineNumber;
+        });
+        size_t out = 0;
+        for (size_t i = 0; i < lines.size(); i++) {
+            if (i + 1 < lines.size() && lines[i + 1].lineNumber == lines[i].lineNumber) continue;
+            lines[out++] = lines[i];
+        }
+        lines.resize(out);
+    }
+    return lines;
+}
+
+std::map<int, std::string> loadSourceFile(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open file: " + path);
+
+    // 整个文件一次读入，再批量扫描
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    std::map<int, std::string> source;
+    for (const SourceLine &line : scanSource(text)) {
+        source.emplace_hint(source.end(), line.lineNumber, std::string(line.code));
+    }
+    return source;
+}
+
+void parseProgram(const std::map<int, std::string> &source, EvaluationContext &context, Program &program,
+                  int parseThreads) {
+    std::vector<std::string_view> codes;
+    codes.reserve(source.size());
+    for (auto it = source.begin(); it != source.end(); ++it) codes.push_back(it->second);
+
+    // 语法分析并行做；符号解析和错误报告仍按行号顺序在当前线程完成
+    std::vector<Statement*> stmts = parseLinesParallel((int)codes.size(),
+        [&](int i) { return codes[i]; }, program.arena(), parseThreads);
+
+    int i = 0;
+    for (auto it = source.begin(); it != source.end(); ++it, ++i) {
+        Statement *stmt = stmts[i];
+        if (!stmt) {
+            // 第一个解析失败的行：重新解析一次，抛出与串行解析相同的错误
+            Parser parser(it->second, program.arena());
+            stmt = parser.parseStatement();
+        }
+        program.add(it->first, stmt);
+        stmt->resolve(context);
+    }
+    program.link();
+}
+
+void parseProgramLazy(const std::map<int, std::string> &source, Program &program) {
+    for (auto it = source.begin(); it != source.end(); ++it) program.addLazy(it->first, it->second);
+}
+
+// 运行期间把 budget 挂到 context 上，无论怎样退出都摘下来
+namespace {
+struct BudgetScope {
+    EvaluationContext &context;
+    BudgetScope(EvaluationContext &context, ExecutionBudget *budget) : context(context) { context.setBudget(budget); }
+    ~BudgetScope() { context.setBudget(nullptr); }
+};
+}
+
+void executeProgram(Program &program, EvaluationContext &context, ExecEngine engine,
+                    Profiler *profiler) {
+    // 执行限制：每次运行重新计时、重新计数
+    ExecutionBudget budget(context.limits());
+    BudgetScope scope(context, context.limits().any() ? &budget : nullptr);
+
+    if (profiler) {
+        // 性能分析：INPUT 的等待时间单独记到当前行，结束后恢复原来的输入端口
+        profiler->reset(program);
+        InputSource *original = context.inputSource();
+        ProfilingInputSource timedInput(original, *profiler);
+        context.setIO(context.outputSink(), &timedInput);
+        try {
+            program.runProfiled(context, *profiler);
+        }
+        catch (...) {
+            context.setIO(context.outputSink(), original);
+            throw;
+        }
+        context.setIO(context.outputSink(), original);
+    }
+    else if (program.isLazy()) {
+        // 延迟解析：字节码和 JIT 要先看到整段程序，还有行没解析时用树遍历边执行边解析
+        program.run(context);
+    }
+    else if (engine == ENGINE_BYTECODE) {
+        // 字节码：先把整段程序编译成扁平指令数组，再交给虚拟机；
+        // 有执行限制时才生成计数指令
+        BytecodeCompiler compiler;
+        BytecodeProgram prog = compiler.compile(program, context.budget() != nullptr);
+        VirtualMachine vm;
+        vm.run(prog, context);
+    }
+    else if (engine == ENGINE_JIT && !context.budget()) {
+        // JIT：先解释执行，出现热循环时编译成机器码；机器码不计数，有执行限制时退回树遍历
+        JitEngine jit;
+        jit.run(program, context);
+    }
+    else if (engine == ENGINE_FLAT) {
+        // 扁平语法树：表达式排进连续数组（转换一次，缓存在 program 中），按种类 switch 求值
+        program.flat().run(context);
+    }
+    else {
+        // 树遍历：参考实现
+        program.run(context);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include "expression.h"
+#include "program.h"
+#include "bytecode.h"
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// === 解释器公共流程 ===
+// 界面和命令行版本共用：读取源码 -> 解析 -> 执行
+
+// 按 LOAD 的规则拆分一行源码："10 LET A = 1" -> 10, "LET A = 1"
+// 第一个单词不是整数时返回 false
+bool splitSourceLine(const std::string &line, int &lineNumber, std::string &code);
+
+// 源码中的一行：code 指向扫描的缓冲区内部，不单独分配
+struct SourceLine {
+    int lineNumber;
+    std::string_view code;
+};
+
+// 【新增】批量扫描：按 splitSourceLine 的规则一次拆完整个缓冲区（例如内存映射的文件），
+// 不为每一行分配内存。结果按行号升序，重复的行号保留最后出现的一行，代码为空的行被跳过
+std::vector<SourceLine> scanSource(std::string_view text);
+
+// 读取整个程序文件，返回 行号 -> 代码；文件打不开时抛出 std::runtime_error
+std::map<int, std::string> loadSourceFile(const std::string &path);
+
+// 解析阶段：逐行解析并做符号解析，最后链接跳转目标；节点分配在 program.arena() 中
+// 大程序的语法分析由多个线程并行完成（见 parallelparse.h），报告的错误与串行解析相同：
+// 语法错误或 GOTO 目标不存在时抛出 std::runtime_error。
+// parseThreads 同 parseLinesParallel 的 threads：已经在线程池的工作线程里时传 1
+void parseProgram(const std::map<int, std::string> &source, EvaluationContext &context, Program &program,
+                  int parseThreads = 0);
+
+// 【新增】延迟解析：只登记行号和源码，每一行第一次执行到时才解析并缓存（见 Program::ensure）。
+// 语法错误和不存在的 GOTO / IF 目标在执行到那一行时才以 LazySyntaxError 报告，执行不到的行不报告
+void parseProgramLazy(const std::map<int, std::string> &source, Program &program);
+
+// 执行阶段：用指定的引擎运行已经解析好的程序；运行时错误抛出 std::runtime_error
+// 传入 profiler 时逐行计时；字节码没有行的边界，此时总是用树遍历执行
+// ENGINE_JIT 在不支持生成机器码的平台上、或者设置了执行限制时，同样用树遍历执行
+// 还有未解析的行（延迟解析）时，任何引擎都用树遍历执行
+// context.limits() 中设置了限制时，超出限制抛出 LimitExceeded（带所在行号和已执行的语句条数）
+void executeProgram(Program &program, EvaluationContext &context, ExecEngine engine,
+                    Profiler *profiler = nullptr);
+
+#endif // INTERPRETER_H
@@ -0,0 +1,63 @@
+#include "io.h"
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <stdexcept>
+
+void StdoutSink::writeLine(const std::string &line) {
+    std::fwrite(line.data(), 1, line.size(), out);
+    std::fputc('\n', out);
+}
+
+void StdoutSink::flush() {
+    std::fflush(out);
+}
+
+int StdinSource::readInt(const std::string &varName) {
+    std::string line;
+    int c;
+    while ((c = std::fgetc(in)) != EOF && c != '\n') line += (char)c;
+    if (c == EOF && line.empty()) throw std::runtime_error("Unexpected end of input for " + varName);
+
+    bool ok;
+    int val = parseIntLine(line, ok);
+    return ok ? val : 0;
+}
+
+int ScriptedInputSource::readInt(const std::string &varName) {
+    if (values.empty()) {
+        if (fallback) return fallback->readInt(varName);
+        throw std::runtime_error("Unexpected end of input for " + varName);
+    }
+    int val = values.front();
+    values.pop_front();
+    return val;
+}
+
+void ScriptedInputSource::pushText(const std::string &text) {
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string::npos) end = text.size();
+        bool ok;
+        int val = parseIntLine(text.substr(begin, end - begin), ok);
+        values.push_back(ok ? val : 0);
+        begin = end + 1;
+    }
+}
+
+int parseIntLine(const std::string &text, bool &ok) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    size_t end = text.find_last_not_of(" \t\r\n");
+    ok = false;
+    if (begin == std::string::npos) return 0;
+
+    std::string trimmed = text.substr(begin, end - begin + 1);
+    char *stop = nullptr;
+    errno = 0;
+    long val = std::strtol(trimmed.c_str(), &stop, 10);
+    if (*stop != '\0' || errno == ERANGE || val < INT_MIN || val > INT_MAX) return 0;
+
+    ok = true;
+    return (int)val;
+}
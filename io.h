@@ -0,0 +1,87 @@
+#ifndef IO_H
+#define IO_H
+
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+// === 程序输出接口 ===
+// PRINT 的每一行结果都交给 OutputSink，解释器本身不关心输出到哪里（界面 / 终端 / 文件）
+class OutputSink {
+public:
+    virtual ~OutputSink() {}
+    virtual void writeLine(const std::string &line) = 0;
+    virtual void flush() {}
+};
+
+// === 程序输入接口 ===
+// INPUT 语句通过 InputSource 读取一个整数
+class InputSource {
+public:
+    virtual ~InputSource() {}
+    virtual int readInt(const std::string &varName) = 0;
+};
+
+// 输出到 C 标准输出（使用 stdio 自带的缓冲，不逐行刷新）
+class StdoutSink : public OutputSink {
+public:
+    StdoutSink(std::FILE *out = stdout) : out(out) {}
+    virtual void writeLine(const std::string &line) override;
+    virtual void flush() override;
+private:
+    std::FILE *out;
+};
+
+// 从 C 标准输入按行读取整数；不是合法整数时得到 0（与界面行为一致），
+// 输入提前结束时抛出 std::runtime_error
+class StdinSource : public InputSource {
+public:
+    StdinSource(std::FILE *in = stdin) : in(in) {}
+    virtual int readInt(const std::string &varName) override;
+private:
+    std::FILE *in;
+};
+
+// 【新增】把输出收集在内存中（批量评测时每个程序一份，互不干扰）
+class CollectingSink : public OutputSink {
+public:
+    std::vector<std::string> lines;
+    virtual void writeLine(const std::string &line) override { lines.push_back(line); }
+};
+
+// 【新增】脚本化输入：依次返回预先给定的值（来自队列或文件），用完后交给 fallback。
+// 没有 fallback 时像 StdinSource 一样报告输入结束，INPUT 程序因此可以无人值守地运行
+class ScriptedInputSource : public InputSource {
+public:
+    ScriptedInputSource(InputSource *fallback = nullptr) : fallback(fallback) {}
+    virtual int readInt(const std::string &varName) override;
+
+    void push(int value) { values.push_back(value); }
+    // 每行一个值，规则与 StdinSource 相同：不是整数的行得到 0
+    void pushText(const std::string &text);
+    void clear() { values.clear(); }
+    size_t remaining() const { return values.size(); }
+
+    void setFallback(InputSource *source) { fallback = source; }
+
+private:
+    std::deque<int> values;
+    InputSource *fallback;
+};
+
+// 把一个函数包装成 InputSource（界面用它接入命令行输入框）
+class CallbackInputSource : public InputSource {
+public:
+    using Handler = std::function<int()>;
+    CallbackInputSource(Handler handler) : handler(handler) {}
+    virtual int readInt(const std::string &) override { return handler(); }
+private:
+    Handler handler;
+};
+
+// 把一行文本解析成整数：首尾空白可忽略，整行必须是一个整数，否则 ok = false
+int parseIntLine(const std::string &text, bool &ok);
+
+#endif // IO_H
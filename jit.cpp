@@ -0,0 +1,452 @@
+#include "jit.h"
+#include "arith.h"
+#include "statement.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <map>
+#include <vector>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define MINIBASIC_NATIVE 1
+#include <sys/mman.h>
+#include <unistd.h>
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+#ifdef MINIBASIC_NATIVE
+
+// 机器码直接把停止标志当作一个字节读取
+static_assert(sizeof(std::atomic<bool>) == 1, "std::atomic<bool> must be a single byte");
+
+namespace {
+
+// ==========================================================
+// ** 的运行时辅助函数
+// ==========================================================
+// 直接复用 arith.h。异常不能穿过没有 unwind 信息的机器码，所以在这里接住，
+// 用超出 int 范围的返回值表示出错，机器码据此退回解释器
+const int64_t POW_FAILED = (int64_t)1 << 40;
+
+int64_t nativePow(int32_t base, int32_t exponent) {
+    try {
+        return basicPow(base, exponent);
+    }
+    catch (...) {
+        return POW_FAILED;
+    }
+}
+
+// ==========================================================
+// Assembler：按字节拼机器码，跳转用 rel32，回填位置由调用者记录
+// ==========================================================
+class Assembler {
+public:
+    std::vector<uint8_t> code;
+
+    size_t pos() const { return code.size(); }
+
+    void bytes(std::initializer_list<uint8_t> list) { code.insert(code.end(), list); }
+
+    void imm32(int32_t value) {
+        uint32_t u = (uint32_t)value;
+        for (int i = 0; i < 4; i++) code.push_back((uint8_t)(u >> (8 * i)));
+    }
+
+    void imm64(uint64_t value) {
+        for (int i = 0; i < 8; i++) code.push_back((uint8_t)(value >> (8 * i)));
+    }
+
+    void patch32(size_t at, int32_t value) {
+        uint32_t u = (uint32_t)value;
+        for (int i = 0; i < 4; i++) code[at + i] = (uint8_t)(u >> (8 * i));
+    }
+
+    // rel32 从字段之后的位置算起
+    void bind(size_t field, size_t target) { patch32(field, (int32_t)(target - (field + 4))); }
+
+    // jmp rel32 / jcc rel32，返回 rel32 字段的位置
+    size_t jmp() { bytes({0xE9}); size_t at = pos(); imm32(0); return at; }
+    size_t je() { bytes({0x0F, 0x84}); size_t at = pos(); imm32(0); return at; }
+    size_t jne() { bytes({0x0F, 0x85}); size_t at = pos(); imm32(0); return at; }
+};
+
+// ==========================================================
+// NativeCompiler：Statement / Expression 树 -> x86-64
+// ==========================================================
+// 寄存器约定（System V ABI）：
+//   参数 rdi = 槽位值数组，rsi = 槽位是否赋值，rdx = 停止标志，ecx = 入口语句下标
+//   rbx / r12 / r13 保存这三个指针，r14 保存序言之后的 rsp（出口直接恢复，不用逐层弹栈）
+//   表达式结果在 eax，二元运算的右操作数在 ecx，左操作数需要保存时压到机器栈上
+class NativeCompiler {
+public:
+    void compile(const Program &program);
+    Assembler a;
+
+private:
+    struct Fixup {
+        size_t field;
+        int index; // 语句下标
+    };
+
+    std::vector<size_t> stmtStart;   // 语句下标 -> 机器码偏移（第 n 项是程序结尾）
+    std::vector<Fixup> jumps;        // 跳到某条语句的机器码
+    std::vector<Fixup> exits;        // 返回解释器，交出某条语句
+    std::vector<size_t> toEpilogue;  // 跳到尾声
+    int current = 0;                 // 正在编译的语句
+    int pushed = 0;                  // 机器栈上保存的临时值个数，调用辅助函数前据此对齐
+
+    static bool isNative(Statement *stmt);
+    static bool isNativeExpression(Expression *exp);
+    static bool isSimple(Expression *exp);
+
+    void compileStatement(Statement *stmt, int index);
+    void compileExpression(Expression *exp);
+    void compileOperands(Expression *lhs, Expression *rhs); // lhs -> eax, rhs -> ecx
+    void loadOperand(Expression *exp, bool intoEcx);
+
+    // 返回解释器：eax = index，跳到尾声
+    void exitTo(int index);
+    // 条件跳转到“从当前语句开头退回解释器”
+    void bailIfZero();          // 条件：ZF = 1
+    void bailIfNotZero();       // 条件：ZF = 0
+    // 跳到语句 target 之前检查停止标志
+    void jumpTo(int target);
+};
+
+bool NativeCompiler::isSimple(Expression *exp) {
+    return exp->type() == CONSTANT || exp->type() == IDENTIFIER;
+}
+
+bool NativeCompiler::isNativeExpression(Expression *exp) {
+    if (exp->type() != COMPOUND) return true;
+    std::string op = exp->getOperator();
+    if (op != "+" && op != "-" && op != "*" && op != "/" && op != "MOD" && op != "**") return false;
+    return isNativeExpression(exp->getLHS()) && isNativeExpression(exp->getRHS());
+}
+
+bool NativeCompiler::isNative(Statement *stmt) {
+    switch (stmt->type()) {
+    case REM_STMT:
+    case GOTO_STMT:
+        return true;
+    case LET_STMT:
+        return isNativeExpression(stmt->getExp());
+    case IF_STMT:
+        return isNativeExpression(stmt->getLHS()) && isNativeExpression(stmt->getRHS());
+    default:
+        return false; // PRINT / INPUT / END 交给解释器
+    }
+}
+
+void NativeCompiler::compile(const Program &program) {
+    int n = program.size();
+    stmtStart.assign(n + 1, 0);
+
+    // 序言：保存被调用者保存的寄存器（5 个，加上返回地址后 rsp 正好 16 字节对齐）
+    a.bytes({0x53});             // push rbx
+    a.bytes({0x41, 0x54});       // push r12
+    a.bytes({0x41, 0x55});       // push r13
+    a.bytes({0x41, 0x56});       // push r14
+    a.bytes({0x41, 0x57});       // push r15
+    a.bytes({0x49, 0x89, 0xE6}); // mov r14, rsp
+    a.bytes({0x48, 0x89, 0xFB}); // mov rbx, rdi
+    a.bytes({0x49, 0x89, 0xF4}); // mov r12, rsi
+    a.bytes({0x49, 0x89, 0xD5}); // mov r13, rdx
+
+    // 按入口下标查表跳转：表项是相对机器码起点的偏移
+    a.bytes({0x48, 0x8D, 0x05}); // lea rax, [rip + disp32]  ; rax = 机器码起点
+    size_t startField = a.pos();
+    a.imm32(0);
+    a.patch32(startField, -(int32_t)(startField + 4));
+    a.bytes({0x48, 0x63, 0xC9}); // movsxd rcx, ecx
+    a.bytes({0x48, 0x63, 0x94, 0x88}); // movsxd rdx, dword [rax + rcx*4 + disp32]
+    size_t tableField = a.pos();
+    a.imm32(0);
+    a.bytes({0x48, 0x01, 0xD0}); // add rax, rdx
+    a.bytes({0xFF, 0xE0});       // jmp rax
+
+    // 语句：顺序排列，正常执行时直接落到下一条
+    for (int i = 0; i < n; i++) {
+        stmtStart[i] = a.pos();
+        compileStatement(program.at(i), i);
+    }
+    stmtStart[n] = a.pos();
+    exitTo(n); // 执行完最后一行
+
+    // 出口：每个语句下标一个 "mov eax, index; jmp 尾声"，放在冷路径上
+    std::map<int, size_t> exitStubs;
+    for (const Fixup &f : exits) {
+        auto it = exitStubs.find(f.index);
+        if (it == exitStubs.end()) {
+            it = exitStubs.emplace(f.index, a.pos()).first;
+            a.bytes({0xB8}); // mov eax, imm32
+            a.imm32(f.index);
+            toEpilogue.push_back(a.jmp());
+        }
+        a.bind(f.field, it->second);
+    }
+
+    // 尾声：直接恢复 rsp，丢掉表达式求值中途保存的临时值
+    size_t epilogue = a.pos();
+    a.bytes({0x4C, 0x89, 0xF4}); // mov rsp, r14
+    a.bytes({0x41, 0x5F});       // pop r15
+    a.bytes({0x41, 0x5E});       // pop r14
+    a.bytes({0x41, 0x5D});       // pop r13
+    a.bytes({0x41, 0x5C});       // pop r12
+    a.bytes({0x5B});             // pop rbx
+    a.bytes({0xC3});             // ret
+    for (size_t field : toEpilogue) a.bind(field, epilogue);
+
+    for (const Fixup &f : jumps) a.bind(f.field, stmtStart[f.index]);
+
+    // 入口表
+    while (a.pos() % 4) a.bytes({0xCC});
+    a.patch32(tableField, (int32_t)a.pos());
+    for (int i = 0; i <= n; i++) a.imm32((int32_t)stmtStart[i]);
+}
+
+void NativeCompiler::exitTo(int index) {
+    a.bytes({0xB8}); // mov eax, imm32
+    a.imm32(index);
+    toEpilogue.push_back(a.jmp());
+}
+
+void NativeCompiler::bailIfZero() {
+    exits.push_back({a.je(), current});
+}
+
+void NativeCompiler::bailIfNotZero() {
+    exits.push_back({a.jne(), current});
+}
+
+void NativeCompiler::jumpTo(int target) {
+    a.bytes({0x41, 0x80, 0x7D, 0x00, 0x00}); // cmp byte [r13], 0
+    exits.push_back({a.jne(), target});      // 请求停止：回到解释器，由它抛出 ExecutionStopped
+    jumps.push_back({a.jmp(), target});
+}
+
+void NativeCompiler::compileStatement(Statement *stmt, int index) {
+    current = index;
+    if (!isNative(stmt)) {
+        exitTo(index);
+        return;
+    }
+
+    switch (stmt->type()) {
+    case LET_STMT: {
+        compileExpression(stmt->getExp());
+        int32_t slot = stmt->getSlot();
+        a.bytes({0x89, 0x83});             // mov [rbx + slot*4], eax
+        a.imm32(slot * 4);
+        a.bytes({0x41, 0xC6, 0x84, 0x24}); // mov byte [r12 + slot], 1
+        a.imm32(slot);
+        a.bytes({0x01});
+        break;
+    }
+
+    case GOTO_STMT:
+        jumpTo(stmt->getTarget());
+        break;
+
+    case IF_STMT: {
+        compileOperands(stmt->getLHS(), stmt->getRHS());
+
+        // 条件不成立时跳过后面 16 字节的“检查停止标志 + 跳转”
+        std::string op = stmt->getOperator();
+        uint8_t skip;
+        if (op == "=") skip = 0x75;      // jne rel8
+        else if (op == "<") skip = 0x7D; // jge rel8
+        else if (op == ">") skip = 0x7E; // jle rel8
+        else break; // 与 IfStmt::execute 一致：不认识的比较符视为条件不成立
+        a.bytes({0x39, 0xC8});           // cmp eax, ecx
+        a.bytes({skip, 0x10});
+        jumpTo(stmt->getTarget());
+        break;
+    }
+
+    default: // REM
+        break;
+    }
+}
+
+// 常数 / 变量直接装入 eax 或 ecx
+void NativeCompiler::loadOperand(Expression *exp, bool intoEcx) {
+    if (exp->type() == CONSTANT) {
+        a.bytes({(uint8_t)(intoEcx ? 0xB9 : 0xB8)}); // mov e?x, imm32
+        a.imm32(exp->getConstantValue());
+    }
+    else {
+        a.bytes({0x8B, (uint8_t)(intoEcx ? 0x8B : 0x83)}); // mov e?x, [rbx + slot*4]
+        a.imm32(exp->getSlot() * 4);
+    }
+}
+
+// 先左后右，与 CompoundExp::eval 的求值顺序一致
+void NativeCompiler::compileOperands(Expression *lhs, Expression *rhs) {
+    if (isSimple(rhs)) {
+        compileExpression(lhs);
+        loadOperand(rhs, true);
+        return;
+    }
+    compileExpression(lhs);
+    a.bytes({0x50}); // push rax
+    pushed++;
+    compileExpression(rhs);
+    a.bytes({0x89, 0xC1}); // mov ecx, eax
+    a.bytes({0x58}); // pop rax
+    pushed--;
+}
+
+void NativeCompiler::compileExpression(Expression *exp) {
+    if (isSimple(exp)) {
+        loadOperand(exp, false);
+        return;
+    }
+
+    std::string op = exp->getOperator();
+    Expression *rhs = exp->getRHS();
+    compileOperands(exp->getLHS(), rhs);
+
+    // 右操作数是常数时，除数的检查在编译时就能做完
+    bool constant = rhs->type() == CONSTANT;
+    int divisor = constant ? rhs->getConstantValue() : 0;
+
+    if (op == "+") a.bytes({0x01, 0xC8});            // add eax, ecx
+    else if (op == "-") a.bytes({0x29, 0xC8});       // sub eax, ecx
+    else if (op == "*") a.bytes({0x0F, 0xAF, 0xC1}); // imul eax, ecx
+    else if (op == "/" || op == "MOD") {
+        // 除以 0 交给解释器报错；INT_MIN / -1 在 idiv 上会触发硬件异常，也交给解释器
+        // （basicDiv 报溢出，basicMod 得 0）。被除数不是 INT_MIN 时除以 -1 照常在这里算
+        if (!constant || divisor == 0) {
+            a.bytes({0x85, 0xC9});       // test ecx, ecx
+            bailIfZero();
+        }
+        if (!constant) {
+            a.bytes({0x83, 0xF9, 0xFF}); // cmp ecx, -1
+            a.bytes({0x75, 0x0B});       // jne +11（跳过下面的 cmp 和 je rel32）
+        }
+        if (!constant || divisor == -1) {
+            a.bytes({0x3D, 0x00, 0x00, 0x00, 0x80}); // cmp eax, INT_MIN
+            bailIfZero();
+        }
+        a.bytes({0x99});                 // cdq
+        a.bytes({0xF7, 0xF9});           // idiv ecx
+        if (op == "MOD") {
+            // 与 basicMod 一致：余数非 0 且与除数异号时加上除数
+            a.bytes({0x89, 0xD0});       // mov eax, edx
+            a.bytes({0x85, 0xC0});       // test eax, eax
+            a.bytes({0x74, 0x08});       // je +8
+            a.bytes({0x89, 0xC2});       // mov edx, eax
+            a.bytes({0x31, 0xCA});       // xor edx, ecx
+            a.bytes({0x79, 0x02});       // jns +2
+            a.bytes({0x01, 0xC8});       // add eax, ecx
+        }
+    }
+    else { // **
+        a.bytes({0x89, 0xC7});           // mov edi, eax
+        a.bytes({0x89, 0xCE});           // mov esi, ecx
+        bool align = pushed % 2 != 0;
+        if (align) a.bytes({0x48, 0x83, 0xEC, 0x08}); // sub rsp, 8
+        a.bytes({0x48, 0xB8});           // mov rax, imm64
+        a.imm64((uint64_t)(uintptr_t)&nativePow);
+        a.bytes({0xFF, 0xD0});           // call rax
+        if (align) a.bytes({0x48, 0x83, 0xC4, 0x08}); // add rsp, 8
+        a.bytes({0x48, 0x63, 0xC8});     // movsxd rcx, eax
+        a.bytes({0x48, 0x39, 0xC1});     // cmp rcx, rax
+        bailIfNotZero();                 // 结果不是 int：出错
+    }
+}
+
+} // namespace
+
+#endif // MINIBASIC_NATIVE
+
+// ==========================================================
+// NativeProgram 实现
+// ==========================================================
+
+bool NativeProgram::available() {
+#ifdef MINIBASIC_NATIVE
+    return true;
+#else
+    return false;
+#endif
+}
+
+NativeProgram::~NativeProgram() {
+#ifdef MINIBASIC_NATIVE
+    if (memory) munmap(memory, size);
+#endif
+}
+
+bool NativeProgram::compile(const Program &program) {
+#ifdef MINIBASIC_NATIVE
+    NativeCompiler compiler;
+    compiler.compile(program);
+    const std::vector<uint8_t> &code = compiler.a.code;
+
+    // 先可写、拷贝，再改成只读可执行（W^X）
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t length = (code.size() + page - 1) / page * page;
+    void *mem = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return false;
+    std::memcpy(mem, code.data(), code.size());
+    if (mprotect(mem, length, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, length);
+        return false;
+    }
+
+    if (memory) munmap(memory, size);
+    memory = mem;
+    size = length;
+    entry = (EntryPoint)mem;
+    return true;
+#else
+    (void)program;
+    return false;
+#endif
+}
+
+int NativeProgram::run(EvaluationContext &context, int pc) const {
+    static const std::atomic<bool> neverStop(false);
+    const std::atomic<bool> *flag = context.stopFlagAddress();
+    return entry(context.slotValues(), context.slotDefined(), flag ? flag : &neverStop, pc);
+}
+
+// ==========================================================
+// JitEngine 实现
+// ==========================================================
+
+void JitEngine::run(Program &program, EvaluationContext &context) {
+    int n = program.size();
+    int pc = 0;
+
+    // 每个跳转目标被跳到的次数；编译过（无论成败）之后不再统计
+    std::vector<int> hits(n, 0);
+    bool tried = !NativeProgram::available();
+
+    while (pc < n) {
+        if (native.ready()) {
+            pc = native.run(context, pc);
+            if (context.stopRequested()) throw ExecutionStopped();
+            if (pc >= n) break;
+        }
+
+        // 机器码交出来的语句，或者还没有编译
+        int next = program.at(pc)->execute(context);
+        if (next == Statement::NEXT_PC) pc++;
+        else if (next == Statement::HALT_PC) break;
+        else {
+            pc = next;
+            if (context.stopRequested()) throw ExecutionStopped();
+            if (!tried && ++hits[pc] >= HOT_THRESHOLD) {
+                tried = true;
+                native.compile(program);
+            }
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "expression.h"
+#include "program.h"
+#include <cstddef>
+
+// === 原生代码 (x86-64) ===
+// 把 LET / IF / GOTO / REM 直接翻译成 x86-64 机器码，放在 mmap 申请的可执行内存中运行。
+// 变量不经过 getSlot / setSlot，机器码按槽位下标直接读写 EvaluationContext 的槽位数组。
+// 不编译的语句（PRINT / INPUT / END）在机器码里只是一个出口：返回它的下标，交给 Statement::execute。
+// 可能出错的运算（除以 0、** 溢出）在机器码里只做检查，出错时从该语句开头退回解释器，
+// 由 Statement::execute 重新执行并抛出与树遍历完全相同的错误（表达式没有副作用，重新求值是安全的）。
+// 只支持 x86-64 的 Linux / macOS，其他平台上 available() 为 false
+class NativeProgram {
+public:
+    NativeProgram() = default;
+    ~NativeProgram();
+
+    NativeProgram(const NativeProgram &) = delete;
+    NativeProgram &operator=(const NativeProgram &) = delete;
+
+    // 当前平台能否生成机器码
+    static bool available();
+
+    // 把整段程序编译成机器码；程序必须已经 resolve、link 过。
+    // 平台不支持或申请可执行内存失败时返回 false，调用者继续解释执行
+    bool compile(const Program &program);
+    bool ready() const { return entry != nullptr; }
+    size_t codeSize() const { return size; }
+
+    // 从语句 pc 开始执行，返回下一条必须由解释器执行的语句下标，
+    // 返回 program.size() 表示程序执行完毕。跳转时发现停止标志也会返回（跳转目标的下标）
+    int run(EvaluationContext &context, int pc) const;
+
+private:
+    typedef int (*EntryPoint)(int *values, char *defined, const void *stopFlag, int pc);
+
+    void *memory = nullptr;
+    size_t size = 0;
+    EntryPoint entry = nullptr;
+};
+
+// === 分层执行：先解释，出现热循环时再编译 ===
+// 开始时与 Program::run 一样逐条 execute；某个跳转目标被跳到 HOT_THRESHOLD 次后，
+// 把整段程序编译成机器码，此后从机器码执行，遇到出口再回到 Statement::execute。
+// 机器码不统计语句条数，有执行限制时应直接用树遍历（executeProgram 会这样做）
+class JitEngine {
+public:
+    static const int HOT_THRESHOLD = 64;
+
+    void run(Program &program, EvaluationContext &context);
+
+    // 本次运行是否用上了机器码
+    bool compiled() const { return native.ready(); }
+
+private:
+    NativeProgram native;
+};
+
+#endif // JIT_H
@@ -4,9 +4,12 @@
 #include "parser.h"
 #include "ui_mainwindow.h"
 #include "statement.h"
+#include "program.h"
+#include "interpreter.h"
 #include <QFileDialog> // 用于打开文件
-#include <QTextStream>
+#include <QFile>
 #include <QMessageBox>
+#include <QElapsedTimer>
 #include <QDebug>
 
 MainWindow::MainWindow(QWidget *parent)
@@ -15,15 +18,26 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
 
-    // 【核心改动】配置 Context，注入输入逻辑
-    // 使用 lambda 表达式包裹我们的 handleInputFromCommandLine
-    globalContext.setUI(ui->textBrowser, [this]() -> int {
-        return this->handleInputFromCommandLine();
-    });
+    // 【核心改动】配置 Context，注入输入输出端口
+    // 【修改】程序在 runner 的工作线程中执行：runner 接管 globalContext 的输入输出，
+    // 输出经队列回到界面线程再写入 outputSink，INPUT 通过 inputRequested 向界面要值
+    outputSink = new TextBrowserSink(ui->textBrowser);
+    runner = new ProgramRunner(globalContext, *outputSink, this);
+    connect(runner, &ProgramRunner::inputRequested, this, &MainWindow::onInputRequested);
+    connect(runner, &ProgramRunner::finished, this, &MainWindow::onRunFinished);
+
+    programCode = new ProgramCodeModel(this);
+    ui->CodeDisplay->setModel(programCode);
+
+    treeModel = new SyntaxTreeModel(this);
+    ui->treeDisplay->setModel(treeModel);
 }
 
 MainWindow::~MainWindow()
 {
+    // 先停下工作线程，它还在使用 globalContext 和 outputSink
+    delete runner;
+    delete outputSink;
     delete ui;
 }
 
@@ -37,6 +51,26 @@ void MainWindow::on_cmdLineEdit_editingFinished()
 
     if (cmd.isEmpty()) return;
 
+    // 【新增】程序正在等待 INPUT：这一行就是输入的值
+    if (runner->isWaitingForInput()) {
+        if (cmd.compare("STOP", Qt::CaseInsensitive) == 0) {
+            on_btnStopCode_clicked();
+            return;
+        }
+        appendMessage(cmd); // 回显
+        bool ok;
+        int val = cmd.toInt(&ok);
+        runner->provideInput(ok ? val : 0);
+        return;
+    }
+
+    // 【新增】运行期间工作线程独占 globalContext 和已解析的语句，只接受 STOP
+    if (runner->isRunning()) {
+        if (cmd.compare("STOP", Qt::CaseInsensitive) == 0) on_btnStopCode_clicked();
+        else appendMessage("Program is running. Type STOP to stop it.");
+        return;
+    }
+
     // 尝试解析行号
     bool isNumber;
     QString firstToken = cmd.section(' ', 0, 0);
@@ -49,12 +83,13 @@ void MainWindow::on_cmdLineEdit_editingFinished()
 
         if (codeContent.isEmpty()) {
             // 输入 "10" -> 删除第10行
-            programCode.erase(lineNumber);
+            programCode->removeLine(lineNumber);
         } else {
             // 输入 "10 ..." -> 插入或更新
-            programCode[lineNumber] = codeContent;
+            programCode->setLine(lineNumber, codeContent);
         }
-        refreshCodeDisplay();
+        // 只有这一行需要重新解析；缓存整体释放时语法树窗口不能再引用旧语句
+        if (parseCache.invalidate(lineNumber)) treeModel->clear();
     }
     else {
         // === 情况 B: 系统命令 (无行号) ===
@@ -62,6 +97,77 @@ void MainWindow::on_cmdLineEdit_editingFinished()
             on_btnRunCode_clicked();
             return;
         }
+        // RUN TREE / RUN VM / RUN JIT / RUN FLAT：本次运行指定执行引擎，便于对比输出和速度
+        else if (cmd.compare("RUN TREE", Qt::CaseInsensitive) == 0) {
+            runProgram(ENGINE_TREE);
+            return;
+        }
+        else if (cmd.compare("RUN VM", Qt::CaseInsensitive) == 0) {
+            runProgram(ENGINE_BYTECODE);
+            return;
+        }
+        else if (cmd.compare("RUN JIT", Qt::CaseInsensitive) == 0) {
+            runProgram(ENGINE_JIT);
+            return;
+        }
+        else if (cmd.compare("RUN FLAT", Qt::CaseInsensitive) == 0) {
+            runProgram(ENGINE_FLAT);
+            return;
+        }
+        // TREE OPTIMIZED / TREE SOURCE：切换语法树窗口显示优化前还是优化后的表达式
+        else if (cmd.compare("TREE OPTIMIZED", Qt::CaseInsensitive) == 0 ||
+                 cmd.compare("TREE SOURCE", Qt::CaseInsensitive) == 0) {
+            showOptimizedTree = cmd.compare("TREE OPTIMIZED", Qt::CaseInsensitive) == 0;
+            parseCache.markDirty();
+            appendMessage(showOptimizedTree ? "Syntax tree: optimized (shown on next RUN)."
+                                            : "Syntax tree: source (shown on next RUN).");
+            return;
+        }
+        // PARSE LAZY / PARSE STRICT：RUN 时每一行执行到才解析，还是先解析整个程序（默认）
+        else if (cmd.compare("PARSE LAZY", Qt::CaseInsensitive) == 0 ||
+                 cmd.compare("PARSE STRICT", Qt::CaseInsensitive) == 0) {
+            lazyParsing = cmd.compare("PARSE LAZY", Qt::CaseInsensitive) == 0;
+            appendMessage(lazyParsing ? "Parsing: lazy (syntax errors are reported when a line is first reached; RUN uses the tree engine)."
+                                      : "Parsing: strict.");
+            return;
+        }
+        // PROFILE ON / PROFILE OFF：之后的 RUN 是否逐行统计；PROFILE：重新打开上次的结果
+        else if (cmd.compare("PROFILE ON", Qt::CaseInsensitive) == 0 ||
+                 cmd.compare("PROFILE OFF", Qt::CaseInsensitive) == 0) {
+            profiling = cmd.compare("PROFILE ON", Qt::CaseInsensitive) == 0;
+            appendMessage(profiling ? "Profiling: on (RUN uses the tree engine while profiling)."
+                                    : "Profiling: off.");
+            return;
+        }
+        else if (cmd.compare("PROFILE", Qt::CaseInsensitive) == 0) {
+            if (!profileDialog) {
+                appendMessage("No profile yet. Type 'PROFILE ON' and RUN first.");
+                return;
+            }
+            profileDialog->show();
+            profileDialog->raise();
+            return;
+        }
+        // LIMIT [STATEMENTS n | TIME ms | OUTPUT lines | OFF]：之后每次 RUN 的执行限制，0 表示不限
+        else if (firstToken.compare("LIMIT", Qt::CaseInsensitive) == 0) {
+            handleLimitCommand(cmd.mid(firstToken.length()).trimmed());
+            return;
+        }
+        // FEED n1 n2 ... | FILE path | OFF：预先给 INPUT 准备的值，RUN 时先用完再向用户要
+        else if (firstToken.compare("FEED", Qt::CaseInsensitive) == 0) {
+            handleFeedCommand(cmd.mid(firstToken.length()).trimmed());
+            return;
+        }
+        // RECORD path | OFF：之后每次 RUN 的输入值、输出和错误记录到会话文件
+        else if (firstToken.compare("RECORD", Qt::CaseInsensitive) == 0) {
+            handleRecordCommand(cmd.mid(firstToken.length()).trimmed());
+            return;
+        }
+        // REPLAY path：用会话文件中的输入重新运行当前程序，并与记录的输出比较
+        else if (firstToken.compare("REPLAY", Qt::CaseInsensitive) == 0) {
+            replayProgram(cmd.mid(firstToken.length()).trimmed());
+            return;
+        }
         else if (cmd.compare("LOAD", Qt::CaseInsensitive) == 0) {
             on_btnLoadCode_clicked();
             return;
@@ -70,20 +176,29 @@ void MainWindow::on_cmdLineEdit_editingFinished()
             on_btnClearCode_clicked();
             return;
         }
+        else if (cmd.compare("STOP", Qt::CaseInsensitive) == 0) {
+            appendMessage("No program is running.");
+            return;
+        }
         else if (cmd.compare("QUIT", Qt::CaseInsensitive) == 0) {
             QApplication::quit();
             return;
         }
         else if (cmd.compare("HELP", Qt::CaseInsensitive) == 0) {
-            ui->textBrowser->append("Help:\n- Type 'LineNumber Code' to edit.\n- Type 'RUN/LOAD/CLEAR/QUIT' to control.\n- Type 'PRINT/LET/INPUT ...' to execute immediately.");
+            appendMessage("Help:\n- Type 'LineNumber Code' to edit.\n- Type 'RUN/LOAD/CLEAR/QUIT' to control, 'STOP' to stop a running program.\n- Type 'RUN TREE', 'RUN VM', 'RUN JIT' or 'RUN FLAT' to pick the execution engine.\n- Type 'TREE OPTIMIZED' or 'TREE SOURCE' to pick the syntax tree view.\n- Type 'PARSE LAZY' to parse each line when it is first reached, 'PARSE STRICT' to parse everything before RUN.\n- Type 'PROFILE ON/OFF' to time each line on RUN, 'PROFILE' to show the results.\n- Type 'LIMIT STATEMENTS n', 'LIMIT TIME ms', 'LIMIT OUTPUT lines' or 'LIMIT OFF' to bound each RUN.\n- Type 'FEED n1 n2 ...' or 'FEED FILE path' to queue INPUT values, 'FEED OFF' to drop them.\n- Type 'RECORD path' to save each RUN's inputs and outputs, 'RECORD OFF' to stop, 'REPLAY path' to rerun a recording.\n- Type 'PRINT/LET/INPUT ...' to execute immediately.");
             return;
         }
 
         // === 情况 C: 立即执行语句 (Immediate Execution) ===
         // 没有行号，也不是命令，尝试当作语句执行
         try {
-            Parser parser(cmd.toStdString());
+            // 【修改】语句在工作线程中执行，源码和节点要活到执行结束，所以放在成员里，下一条立即语句时再释放
+            immediateLine = cmd.toStdString(); // Parser 不拷贝源码
+            immediateArena.reset();
+            Parser parser(immediateLine, immediateArena);
             Statement *stmt = parser.parseStatement();
+            // 按名字解析到 globalContext 的槽位，与程序中的同名变量共享
+            stmt->resolve(globalContext);
 
             // 检查是否允许立即执行
             // 题目要求：LET, PRINT, INPUT 可以立即执行
@@ -92,40 +207,129 @@ void MainWindow::on_cmdLineEdit_editingFinished()
                 dynamic_cast<PrintStmt*>(stmt) ||
                 dynamic_cast<InputStmt*>(stmt)) {
 
-                // 执行 (使用 globalContext)
-                stmt->execute(globalContext);
+                // 执行 (使用 globalContext)；INPUT 也能像程序中一样等待输入
+                immediateMode = true;
+                runner->start([this, stmt]() { stmt->execute(globalContext); });
             }
             else {
-                ui->textBrowser->append("Error: This statement requires a line number.");
+                appendMessage("Error: This statement requires a line number.");
             }
-
-            delete stmt; // 用完即删
         }
         catch (std::exception &e) {
             // 解析失败，说明不是合法的 Basic 语句，也不是命令
-            ui->textBrowser->append("Error: Unknown command or syntax error.");
+            appendMessage("Error: Unknown command or syntax error.");
         }
     }
 }
-// 辅助函数：遍历 map 更新 UI
-void MainWindow::refreshCodeDisplay()
+void MainWindow::handleLimitCommand(const QString &args)
+{
+    ExecutionLimits limits = globalContext.limits();
+    QString kind = args.section(' ', 0, 0);
+    bool ok = true;
+    long long value = args.section(' ', 1, 1).toLongLong(&ok);
+
+    if (args.isEmpty()) {
+        // 只显示当前设置
+    }
+    else if (kind.compare("OFF", Qt::CaseInsensitive) == 0) {
+        limits = ExecutionLimits();
+    }
+    else if (!ok || value < 0) {
+        appendMessage("Error: LIMIT needs a non-negative number.");
+        return;
+    }
+    else if (kind.compare("STATEMENTS", Qt::CaseInsensitive) == 0) limits.maxStatements = value;
+    else if (kind.compare("TIME", Qt::CaseInsensitive) == 0) limits.maxMillis = value;
+    else if (kind.compare("OUTPUT", Qt::CaseInsensitive) == 0) limits.maxOutputLines = value;
+    else {
+        appendMessage("Error: Usage: LIMIT [STATEMENTS n | TIME ms | OUTPUT lines | OFF]");
+        return;
+    }
+    globalContext.setLimits(limits);
+
+    auto show = [](long long v) { return v > 0 ? QString::number(v) : QString("none"); };
+    appendMessage(QString("Limits: statements %1, time %2 ms, output %3 lines.")
+                  .arg(show(limits.maxStatements), show(limits.maxMillis), show(limits.maxOutputLines)));
+}
+
+void MainWindow::handleFeedCommand(const QString &args)
 {
-    ui->CodeDisplay->clear();
-    // 遍历 map，因为它自动按 Key (行号) 排序
-    for (auto it = programCode.begin(); it != programCode.end(); ++it) {
-        // 拼接格式： "10 LET A = 1"
-        QString lineStr = QString::number(it->first) + " " + it->second;
-        ui->CodeDisplay->append(lineStr);
+    if (args.compare("OFF", Qt::CaseInsensitive) == 0) {
+        feedInput.clear();
+    }
+    else if (args.section(' ', 0, 0).compare("FILE", Qt::CaseInsensitive) == 0) {
+        QString path = args.section(' ', 1).trimmed();
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            appendMessage("Error: Cannot open " + path);
+            return;
+        }
+        feedInput.pushText(file.readAll().toStdString());
+    }
+    else if (!args.isEmpty()) {
+        // 先全部检查，有一个不是整数就一个都不加
+        std::vector<int> values;
+        for (const QString &token : args.split(' ', Qt::SkipEmptyParts)) {
+            bool ok;
+            int value = token.toInt(&ok);
+            if (!ok) {
+                appendMessage("Error: Usage: FEED n1 n2 ... | FILE path | OFF");
+                return;
+            }
+            values.push_back(value);
+        }
+        for (int value : values) feedInput.push(value);
+    }
+    appendMessage(QString("Feed: %1 INPUT values queued.").arg((int)feedInput.remaining()));
+}
+
+void MainWindow::handleRecordCommand(const QString &args)
+{
+    if (args.compare("OFF", Qt::CaseInsensitive) == 0) {
+        recording = false;
+    }
+    else if (!args.isEmpty()) {
+        recording = true;
+        recordPath = args;
+    }
+    appendMessage(recording ? "Recording: each RUN is saved to " + recordPath + "."
+                            : QString("Recording: off."));
+}
+
+void MainWindow::replayProgram(const QString &path)
+{
+    if (path.isEmpty()) {
+        appendMessage("Error: Usage: REPLAY path");
+        return;
+    }
+    try {
+        replayLog = SessionLog::load(path.toStdString());
+    }
+    catch (std::exception &e) {
+        appendMessage("Error: " + QString::fromStdString(e.what()));
+        return;
     }
+    replaying = true;
+    runProgram(ENGINE_BYTECODE);
+    if (!runner->isRunning()) replaying = false; // 语法错误等，没有开始运行
+}
+
+void MainWindow::appendMessage(const QString &msg)
+{
+    outputSink->flush();
+    ui->textBrowser->append(msg);
 }
 
 // 实现 CLEAR 功能
 void MainWindow::on_btnClearCode_clicked()
 {
-    programCode.clear();
-    ui->CodeDisplay->clear();
+    if (runner->isRunning()) return;
+
+    programCode->clear();
+    treeModel->clear();
+    parseCache.clear();
+    outputSink->discard();
     ui->textBrowser->clear();
-    ui->treeDisplay->clear();
 
     // 【新增】只有点击 CLEAR 时才清空变量表
     globalContext.clear();
@@ -134,168 +338,225 @@ void MainWindow::on_btnClearCode_clicked()
 // 实现 LOAD 功能
 void MainWindow::on_btnLoadCode_clicked()
 {
+    if (runner->isRunning()) return;
+
     QString fileName = QFileDialog::getOpenFileName(this, tr("Open Basic File"), "", tr("Text Files (*.txt)"));
 
     if (fileName.isEmpty()) return;
 
+    // 【修改】批量加载：整个文件内存映射后一次扫描，不再逐行构造 QString 再 section / toInt / mid
+    QElapsedTimer timer;
+    timer.start();
+
     QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    if (!file.open(QIODevice::ReadOnly)) {
+        appendMessage("Error: Cannot open " + fileName);
         return;
+    }
 
-    // 清空当前代码（或者你可以选择保留，看需求）
-    programCode.clear();
+    qint64 size = file.size();
+    uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+    QByteArray contents; // 无法映射时（例如管道等特殊文件）退回一次性读入
+    std::string_view text;
+    if (mapped) {
+        text = std::string_view(reinterpret_cast<const char *>(mapped), (size_t)size);
+    } else {
+        contents = file.readAll();
+        text = std::string_view(contents.constData(), (size_t)contents.size());
+    }
 
-    QTextStream in(&file);
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-        if (line.isEmpty()) continue;
+    std::vector<SourceLine> lines = scanSource(text);
 
-        // 解析每一行文件
-        bool isNumber;
-        QString firstToken = line.section(' ', 0, 0);
-        int lineNumber = firstToken.toInt(&isNumber);
+    // scanSource 的结果已按行号排好序，整体放入代码模型，视图只 reset 一次
+    treeModel->clear();
+    parseCache.clear();
+    programCode->load(lines);
 
-        if (isNumber) {
-            QString codeContent = line.mid(firstToken.length()).trimmed();
-            if (!codeContent.isEmpty()) {
-                programCode[lineNumber] = codeContent;
-            }
-        }
-    }
+    if (mapped) file.unmap(mapped);
 
-    refreshCodeDisplay();
-    ui->textBrowser->append("Loaded: " + fileName);
+    appendMessage(QString("Loaded: %1 (%2 lines in %3 ms)")
+                  .arg(fileName)
+                  .arg((int)lines.size())
+                  .arg(timer.elapsed()));
 }
 
 //RUN
 void MainWindow::on_btnRunCode_clicked()
 {
+    // 默认使用字节码虚拟机
+    runProgram(ENGINE_BYTECODE);
+}
+
+void MainWindow::runProgram(ExecEngine engine)
+{
+    if (runner->isRunning()) return;
+
     // 1. 清理 UI
-    ui->treeDisplay->clear();
+    outputSink->discard();
     ui->textBrowser->clear();
 
-    if (programCode.empty()) return;
+    if (programCode->empty()) {
+        treeModel->clear();
+        return;
+    }
     //2.不再重置变量表
 
     // 3. 解析阶段 (Parsing Phase)
     // 将代码文本转换为 Statement 对象，并显示语法树
-    std::map<int, Statement*> statementMap;
-
-    try {
-        for (auto it = programCode.begin(); it != programCode.end(); ++it) {
-            int lineNum = it->first;
-            QString codeStr = it->second;
-
-            // 调用 Parser 解析当前行
-            Parser parser(codeStr.toStdString());
-            Statement *stmt = parser.parseStatement();
-            statementMap[lineNum] = stmt;
-
-            // === 语法树显示逻辑 (修复版) ===
-            // 目标格式: "100 REM ..." (根节点在行号后面，子节点换行缩进)
-
-            // 获取缩进为0的字符串 (例如 "REM\n    Comment...")
-            std::string rawTree = stmt->toString(0);
-            QString treeStr = QString::fromStdString(rawTree);
-
-            // 去掉末尾可能多余的换行符
-            if (treeStr.endsWith('\n')) treeStr.chop(1);
-
-            // 拼接到 treeDisplay
-            ui->treeDisplay->append(QString::number(lineNum) + " " + treeStr);
+    // 【修改】语句来自 parseCache：只有编辑过的行才需要重新解析，
+    // 程序没有变化时连语法树也不用更新
+    bool redrawTree = parseCache.isDirty();
+
+    // 语句归 parseCache 所有，Program 只是按行号排好的视图；
+    // 工作线程执行期间一直要用，所以放在成员里，下次 RUN 时替换
+    runningProgram.reset(new Program);
+    Program &program = *runningProgram;
+
+    if (lazyParsing) {
+        // 【新增】延迟解析：只登记行号和源码，不经过 parseCache；
+        // 语法树窗口先显示全部未解析，运行结束后再显示执行到的行
+        for (int row = 0; row < programCode->size(); row++) {
+            program.addLazy(programCode->lineAt(row), programCode->codeAt(row).toStdString());
         }
+        parseCache.markDirty(); // 语法树窗口不再显示缓存中的语句，下次严格解析时重新设置
+        treeModel->setProgram(program, showOptimizedTree);
     }
-    catch (std::exception &e) {
-        ui->textBrowser->append("Syntax Error: " + QString::fromStdString(e.what()));
-        // 解析失败，清理已分配的内存
-        for (auto pair : statementMap) delete pair.second;
-        return;
-    }
-
-    // 4. 执行阶段 (Execution Phase)
-    try {
-        auto it = statementMap.begin();
-        while (it != statementMap.end()) {
-            Statement *currentStmt = it->second;
+    else {
+        try {
+            // 【新增】先把缓存中没有的行交给多个线程并行解析；
+            // 下面的循环仍逐行取语句，第一个语法错误照旧在那里按行号顺序报告。
+            // 只有未命中的行才转成 std::string 保存（解析线程只拿视图），程序没改时这里什么也不做
+            std::vector<int> lineNumbers;
+            std::vector<std::string> codes;
+            for (int row = 0; row < programCode->size(); row++) {
+                int lineNum = programCode->lineAt(row);
+                if (parseCache.find(lineNum)) continue;
+                lineNumbers.push_back(lineNum);
+                codes.push_back(programCode->codeAt(row).toStdString());
+            }
+            if (!lineNumbers.empty()) {
+                parseCache.prefetch(lineNumbers, [&](int i) { return std::string_view(codes[i]); }, globalContext);
+            }
 
-            try {
-                // 执行语句
-                currentStmt->execute(globalContext);
+            for (int row = 0; row < programCode->size(); row++) {
+                int lineNum = programCode->lineAt(row);
 
-                // 正常执行下一行
-                it++;
-            }
-            catch (GotoSignal &sig) {
-                // 捕获 GOTO 信号，查找目标行
-                auto targetIt = statementMap.find(sig.targetLine);
-                if (targetIt == statementMap.end()) {
-                    throw std::runtime_error("Line number not found: " + std::to_string(sig.targetLine));
-                }
-                it = targetIt; // 跳转迭代器
+                // 缓存未命中时才调用 Parser 解析当前行（同时完成符号解析）；
+                // 到这里还没命中的只剩语法错误的行，第一行就会抛出
+                Statement *stmt = parseCache.find(lineNum);
+                if (!stmt) stmt = parseCache.parse(lineNum, programCode->codeAt(row).toStdString(), globalContext);
+                program.add(lineNum, stmt);
             }
+
+            // 链接：所有 GOTO / IF 的目标行在执行前检查并解析成下标
+            program.link();
         }
-    }
-    catch (EndSignal &) {
-        // 捕获 END 信号，正常退出循环
-        // ui->textBrowser->append("--- Program Ended ---");
-    }
-    catch (std::exception &e) {
-        // 捕获运行时错误 (如除以0)
-        ui->textBrowser->append("Runtime Error: " + QString::fromStdString(e.what()));
+        catch (std::exception &e) {
+            // 出错时缓存保持 dirty，下次 RUN 会重新设置完整的语法树；
+            // 这次先显示出错之前已经解析好的行
+            treeModel->setProgram(program, showOptimizedTree);
+            appendMessage("Syntax Error: " + QString::fromStdString(e.what()));
+            return;
+        }
+        parseCache.markClean();
+
+        // 【修改】语法树窗口只记下语句，文本在滚动到 / 展开时才生成
+        if (redrawTree) treeModel->setProgram(program, showOptimizedTree);
     }
 
-    // 5. 内存清理
-    for (auto pair : statementMap) {
-        delete pair.second;
+    // 4. 执行阶段 (Execution Phase)
+    // 【修改】交给工作线程，界面保持响应；结束时在 onRunFinished 中报告
+    runLabel = profiling ? "Tree (profiled)" : engine == ENGINE_BYTECODE ? "VM" : engine == ENGINE_JIT ? "JIT" : engine == ENGINE_FLAT ? "Flat" : "Tree";
+    if (lazyParsing && !profiling) runLabel = "Tree (lazy)"; // 还有未解析的行时总是树遍历
+    if (replaying) runLabel = "Replay";
+    immediateMode = false;
+    runTimer.start();
+    Profiler *runProfiler = profiling && !replaying ? &profiler : nullptr;
+    if (recording) {
+        sessionLog.clear();
+        sessionLog.captureVariables(globalContext); // 工作线程还没开始，可以在这里读 globalContext
     }
+    runner->start([this, engine, runProfiler]() {
+        if (replaying) {
+            // 【新增】回放：输入全部来自记录，不再提示用户；运行时错误也作为记录的一部分比较
+            ReplayResult result = replaySession(*runningProgram, globalContext, engine, replayLog,
+                                                globalContext.outputSink());
+            replayReport = result.matched
+                ? QString("Replay matched: %1 inputs, %2 output lines.").arg(result.inputs).arg(result.outputs)
+                : "Replay mismatch at " + QString::fromStdString(result.mismatch);
+            return;
+        }
+        // 【新增】FEED 的值先用完再向用户要；RECORD 时在输入输出外面各套一层记录
+        feedInput.setFallback(globalContext.inputSource());
+        RecordingInputSource recordingInput(&feedInput, sessionLog);
+        RecordingSink recordingOutput(globalContext.outputSink(), sessionLog);
+        ScopedIO io(globalContext,
+                    recording ? (OutputSink *)&recordingOutput : globalContext.outputSink(),
+                    recording ? (InputSource *)&recordingInput : (InputSource *)&feedInput);
+        executeProgram(*runningProgram, globalContext, engine, runProfiler);
+    });
+    statusBar()->showMessage(runLabel + ": running... (type STOP to stop)");
 }
 
-// 【新增】黑科技：命令行原地输入处理
-int MainWindow::handleInputFromCommandLine()
+// STOP：请求工作线程停止，真正停下后由 onRunFinished 报告
+void MainWindow::on_btnStopCode_clicked()
 {
-    // 1. 准备界面
-    ui->textBrowser->append(" ? ");
-    ui->cmdLineEdit->setFocus();
-
-    // 2. 暂时断开主逻辑连接 (防止冲突)
-    // 使用 0, 0 可以断开该信号的所有连接，更彻底
-    ui->cmdLineEdit->disconnect(SIGNAL(editingFinished()));
-
-    // 3. 准备抓取变量
-    QString capturedText;
-    QEventLoop loop;
-
-    // 4. 建立临时的连接
-    // 逻辑：当按下回车时 -> 1.马上保存文本 -> 2.退出循环
-    // 注意：这里使用了 C++11 Lambda 表达式，[&] 表示引用捕获外部变量
-    auto conn = connect(ui->cmdLineEdit, &QLineEdit::returnPressed, [&](){
-        capturedText = ui->cmdLineEdit->text().trimmed(); // 【关键】立刻抓取！
-        loop.quit();
-    });
-
-    // 5. 阻塞等待
-    loop.exec();
-
-    // 6. 清理现场
-    // 断开刚才建立的临时 lambda 连接
-    disconnect(conn);
+    if (!runner->isRunning()) return;
+    runner->stop();
+}
 
-    // 清空输入框 (此时文本已经被 capturedText 保存了，可以放心清空)
-    ui->cmdLineEdit->clear();
+// 工作线程的 INPUT 需要一个值：提示用户在命令行输入
+void MainWindow::onInputRequested(const QString &varName)
+{
+    appendMessage(varName + " ? ");
+    ui->cmdLineEdit->setFocus();
+}
 
-    // 回显
-    ui->textBrowser->append(capturedText);
+void MainWindow::onRunFinished(const QString &error, ProgramRunner::ErrorKind kind, bool stopped)
+{
+    // runner 已经把剩余的输出全部刷到界面
+    if (stopped) appendMessage("Program stopped.");
+    else if (!error.isEmpty()) {
+        // 与命令行版本的措辞一致：超出限制不是程序本身的运行时错误
+        const char *prefix = kind == ProgramRunner::SYNTAX_ERROR ? "Syntax Error: "
+                           : kind == ProgramRunner::LIMIT_ERROR ? "Limit Error: " : "Runtime Error: ";
+        appendMessage(prefix + error); // 捕获运行时错误 (如除以0)
+    }
 
-    // 7. 恢复主逻辑连接
-    connect(ui->cmdLineEdit, &QLineEdit::editingFinished, this, &MainWindow::on_cmdLineEdit_editingFinished);
+    if (immediateMode) return;
 
-    // 8. 转换并返回
-    bool ok;
-    int val = capturedText.toInt(&ok);
+    // 【新增】延迟解析：显示这次执行到并解析了的行
+    if (runningProgram && lazyParsing) treeModel->setProgram(*runningProgram, showOptimizedTree);
 
-    // 如果想要更友好的调试信息：
-    // ui->textBrowser->append("[Debug] Captured: '" + capturedText + "' -> Int: " + QString::number(val));
+    if (replaying) {
+        replaying = false;
+        if (!stopped && error.isEmpty()) appendMessage(replayReport);
+    }
+    else if (recording) {
+        // 停止的运行也保存：记录到停止为止的部分
+        if (!error.isEmpty()) sessionLog.addError(error.toStdString());
+        try {
+            sessionLog.save(recordPath.toStdString());
+            appendMessage(QString("Recorded %1 inputs and %2 output lines to %3.")
+                          .arg(sessionLog.count(SessionLog::INPUT_EVENT))
+                          .arg(sessionLog.count(SessionLog::OUTPUT_EVENT))
+                          .arg(recordPath));
+        }
+        catch (std::exception &e) {
+            appendMessage("Error: " + QString::fromStdString(e.what()));
+        }
+    }
 
-    if (!ok) return 0;
-    return val;
+    statusBar()->showMessage(QString("%1: %2 ms%3")
+                             .arg(runLabel)
+                             .arg(runTimer.elapsed())
+                             .arg(stopped ? " (stopped)" : ""));
+
+    // 出错时也显示：已经执行的部分和出错的那一行都有统计
+    if (profiling) {
+        if (!profileDialog) profileDialog = new ProfileDialog(this);
+        profileDialog->setProfile(profiler);
+        profileDialog->show();
+        profileDialog->raise();
+    }
 }
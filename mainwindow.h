@@ -2,9 +2,18 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <map>  // 【新增】用于存储代码
 #include "expression.h"
-#include <QEventLoop>
+#include "bytecode.h"
+#include "guiio.h"
+#include "parsecache.h"
+#include "profiler.h"
+#include "profiledialog.h"
+#include "syntaxtreemodel.h"
+#include "programcodemodel.h"
+#include "programrunner.h"
+#include "session.h"
+#include <QElapsedTimer>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -23,23 +32,75 @@ private slots:
     void on_btnLoadCode_clicked();         // 【新增】处理 LOAD 按钮
     void on_btnClearCode_clicked();        // 【新增】处理 CLEAR 按钮
     void on_btnRunCode_clicked();
+    void on_btnStopCode_clicked();        // 【新增】停止正在运行的程序
+
+    // 【新增】工作线程的通知
+    void onInputRequested(const QString &varName);
+    void onRunFinished(const QString &error, ProgramRunner::ErrorKind kind, bool stopped);
 
 private:
     Ui::MainWindow *ui;
 
     // 【新增】核心数据结构：存储 BASIC 程序代码
-    // Key (int): 行号
-    // Value (QString): 代码内容
-    std::map<int, QString> programCode;
+    // 【修改】按行号排好序的 行号 -> 代码内容，同时是代码窗口的模型，编辑时只更新受影响的行
+    ProgramCodeModel *programCode;
+
+    // 【新增】已解析语句的缓存，与 programCode 同步失效
+    ParseCache parseCache;
+
+    // 【新增】在工作线程中执行程序；运行期间（包括停在 INPUT 上）
+    // LOAD / CLEAR / RUN / 编辑都不能进行，它们会释放或修改正在执行的语句
+    ProgramRunner *runner;
+    std::unique_ptr<Program> runningProgram; // 正在 / 最近执行的程序视图
+    QString runLabel;                        // 状态栏显示的执行引擎
+    QElapsedTimer runTimer;
+    bool immediateMode = false;              // 正在执行的是立即模式语句而不是整个程序
+
+    // 【新增】立即模式语句的源码和节点，在工作线程执行完之前必须保持有效
+    std::string immediateLine;
+    Arena immediateArena;
+
+    // 【新增】语法树窗口显示优化后的表达式树，还是源码对应的原始树
+    bool showOptimizedTree = false;
+
+    // 【新增】PARSE LAZY：RUN 时不预先解析，每一行第一次执行到时才解析（语句归 runningProgram 所有）
+    bool lazyParsing = false;
+
+    // 【新增】逐行性能分析：PROFILE ON 后每次 RUN 都统计，结果显示在 profileDialog 中
+    bool profiling = false;
+    Profiler profiler;
+    ProfileDialog *profileDialog = nullptr; // 第一次需要时创建，随窗口释放
+
+    // 【新增】脚本化输入和会话记录 / 回放（只在工作线程运行期间由它访问）
+    ScriptedInputSource feedInput;     // FEED 预先给出的值，用完后再向用户要
+    bool recording = false;            // RECORD：每次 RUN 的输入输出存到 recordPath
+    QString recordPath;
+    SessionLog sessionLog;
+    bool replaying = false;            // REPLAY：这次 RUN 用 replayLog 中的输入，结果写到 replayReport
+    SessionLog replayLog;
+    QString replayReport;
+
+    // 【新增】语法树窗口的模型：只在显示时才生成每行的语法树文本
+    SyntaxTreeModel *treeModel;
 
     // 【新增】全局上下文，用于存储变量
     // 这样我们在立即模式下定义的变量 (LET A=10) 才能被后面的 PRINT A 访问
     EvaluationContext globalContext;
 
-    // 【新增】辅助函数：将 map 中的代码刷新显示到 CodeDisplay
-    void refreshCodeDisplay();
-    // 【新增】辅助函数：处理 INPUT 阻塞等待
-    int handleInputFromCommandLine();
+    // 【新增】界面一侧的输出：runner 从队列取出的行写到 textBrowser
+    TextBrowserSink *outputSink;
+
+    // 【新增】辅助函数：向输出窗口追加一条消息（先刷新缓冲的 PRINT 输出，保证顺序）
+    void appendMessage(const QString &msg);
+    // 【新增】LIMIT 命令：设置 / 显示每次 RUN 的执行限制
+    void handleLimitCommand(const QString &args);
+    // 【新增】FEED / RECORD / REPLAY 命令
+    void handleFeedCommand(const QString &args);
+    void handleRecordCommand(const QString &args);
+    void replayProgram(const QString &path);
+
+    // 【新增】解析并运行整个程序；engine 选择树遍历或字节码虚拟机
+    void runProgram(ExecEngine engine);
 
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,66 @@
+#include "optimizer.h"
+#include <stdexcept>
+
+Optimizer::Optimizer(Arena &arena) : arena(arena) {}
+
+static bool isConstant(Expression *exp, int value) {
+    return exp->type() == CONSTANT && exp->getConstantValue() == value;
+}
+
+bool Optimizer::cannotFail(Expression *exp) {
+    if (exp->type() != COMPOUND) return true;
+
+    std::string_view op = static_cast<CompoundExp*>(exp)->getOperatorName();
+    if (op == "/" || op == "MOD" || op == "**") return false; // ** 可能溢出
+    return cannotFail(exp->getLHS()) && cannotFail(exp->getRHS());
+}
+
+Expression *Optimizer::optimize(Expression *exp) {
+    if (exp->type() != COMPOUND) return exp;
+
+    // 先优化子树（后序遍历）
+    Expression *lhs = optimize(exp->getLHS());
+    Expression *rhs = optimize(exp->getRHS());
+    std::string_view op = static_cast<CompoundExp*>(exp)->getOperatorName(); // 静态常量，可以直接共用
+
+    // 1. 常量折叠：直接借用 CompoundExp::eval，保证和运行时的结果完全一致
+    if (lhs->type() == CONSTANT && rhs->type() == CONSTANT) {
+        CompoundExp folded(op, lhs, rhs);
+        try {
+            return arena.make<ConstantExp>(folded.eval(constContext));
+        }
+        catch (std::runtime_error &) {
+            // 除以 0：不折叠，留给运行时报错
+        }
+    }
+
+    // 2. 代数化简
+    if (op == "+") {
+        if (isConstant(rhs, 0)) return lhs;
+        if (isConstant(lhs, 0)) return rhs;
+    }
+    else if (op == "-") {
+        if (isConstant(rhs, 0)) return lhs;
+    }
+    else if (op == "*") {
+        if (isConstant(rhs, 1)) return lhs;
+        if (isConstant(lhs, 1)) return rhs;
+        if ((isConstant(rhs, 0) && cannotFail(lhs)) || (isConstant(lhs, 0) && cannotFail(rhs))) {
+            return arena.make<ConstantExp>(0);
+        }
+    }
+    else if (op == "/") {
+        if (isConstant(rhs, 1)) return lhs;
+    }
+    else if (op == "MOD") {
+        if (isConstant(rhs, 1) && cannotFail(lhs)) return arena.make<ConstantExp>(0);
+    }
+    else if (op == "**") {
+        if (isConstant(rhs, 1)) return lhs;
+        if (isConstant(rhs, 0) && cannotFail(lhs)) return arena.make<ConstantExp>(1);
+    }
+
+    // 子树没变就复用原节点，否则新建一个
+    if (lhs == exp->getLHS() && rhs == exp->getRHS()) return exp;
+    return CompoundExp::make(arena, op, lhs, rhs);
+}
@@ -0,0 +1,30 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "expression.h"
+#include "arena.h"
+
+// === 表达式优化 ===
+// 在 Parser::parseExpression 之后运行：
+//   1. 常量折叠：两边都是常数的 CompoundExp 直接算出结果，换成一个 ConstantExp
+//   2. 代数化简：x+0, 0+x, x-0, x*1, 1*x, x/1, x**1 -> x
+//                x*0, 0*x, x MOD 1 -> 0；x**0 -> 1（仅当 x 求值不会出错时）
+// 求值会出错的常量（除数为 0、幂运算溢出）不折叠，保留到运行时再报错。
+// 原来的树保持不变：需要改动的节点在 arena 中新建，没改动的子树直接共用，
+// 所以界面可以选择显示原始树或优化后的树。
+class Optimizer {
+public:
+    Optimizer(Arena &arena);
+
+    // 返回优化后的树（可能就是 exp 本身）
+    Expression *optimize(Expression *exp);
+
+private:
+    Arena &arena;
+    EvaluationContext constContext; // 折叠常量时用的空上下文
+
+    // exp 求值时是否一定不会抛异常（不含除法 / MOD / 幂运算）
+    bool cannotFail(Expression *exp);
+};
+
+#endif // OPTIMIZER_H
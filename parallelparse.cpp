@@ -0,0 +1,58 @@
+#include "parallelparse.h"
+#include "parser.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+// 少于这么多行时不值得开线程
+static const int MIN_PARALLEL_LINES = 4096;
+// 每次领取的最少行数：太小则争抢计数器，太大则负载不均
+static const int MIN_CHUNK_LINES = 256;
+
+static Statement *tryParse(std::string_view code, Arena &arena) {
+    try {
+        Parser parser(code, arena);
+        return parser.parseStatement(); // 出错时 Parser 会回滚本行分配的节点
+    }
+    catch (std::exception &) {
+        return nullptr;
+    }
+}
+
+std::vector<Statement*> parseLinesParallel(int count, const LineSource &codeAt, Arena &target, int threads) {
+    std::vector<Statement*> stmts(count, nullptr);
+
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (count < MIN_PARALLEL_LINES || threads <= 1) {
+        for (int i = 0; i < count; i++) {
+            stmts[i] = tryParse(codeAt(i), target);
+        }
+        return stmts;
+    }
+
+    // 工作线程从共享计数器领取连续的一段行，直到领完；每个线程一个 Arena
+    threads = std::min(threads, count / MIN_CHUNK_LINES);
+    int chunk = std::max(MIN_CHUNK_LINES, count / (threads * 8));
+    std::atomic<int> next(0);
+    std::vector<Arena> arenas(threads);
+
+    auto worker = [&](int id) {
+        Arena &arena = arenas[id];
+        while (true) {
+            int begin = next.fetch_add(chunk);
+            if (begin >= count) break;
+            int end = std::min(count, begin + chunk);
+            for (int i = begin; i < end; i++) {
+                stmts[i] = tryParse(codeAt(i), arena); // 每个下标只有一个线程写
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int id = 1; id < threads; id++) pool.emplace_back(worker, id);
+    worker(0); // 当前线程也参与
+    for (std::thread &t : pool) t.join();
+
+    for (Arena &arena : arenas) target.adopt(arena);
+    return stmts;
+}
@@ -0,0 +1,28 @@
+#ifndef PARALLELPARSE_H
+#define PARALLELPARSE_H
+
+#include "statement.h"
+#include "arena.h"
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// === 并行解析 ===
+// 每一行都由独立的 Parser / Tokenizer 解析，互不依赖，可以分给多个线程同时做。
+// 各线程把节点分配在自己的 Arena 中，全部结束后并入 target。
+// 这里只做语法分析，不做符号解析（resolve 会修改 EvaluationContext，
+// 调用者应按行号顺序在当前线程里完成）。
+
+// 第 i 行的代码；会在工作线程中并发调用，只能读取共享数据。
+// 返回的是视图，不拷贝：指向的字符串由调用者持有，在 parseLinesParallel 返回之前不能变
+using LineSource = std::function<std::string_view(int)>;
+
+// 解析 count 行，返回与之一一对应的语句；解析失败的行为 nullptr。
+// 不在这里报告错误：调用者按行号顺序遇到第一个 nullptr 时，
+// 在当前线程重新解析这一行，得到与串行解析完全相同的异常。
+// 行数较少时直接在当前线程解析，避免创建线程的开销。
+// threads 是最多使用的线程数（含当前线程），<= 0 时使用 CPU 核数；
+// 调用者自己已经在线程池里并行时传 1，不再另开线程
+std::vector<Statement*> parseLinesParallel(int count, const LineSource &codeAt, Arena &target, int threads = 0);
+
+#endif // PARALLELPARSE_H
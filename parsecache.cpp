@@ -0,0 +1,59 @@
+#include "parsecache.h"
+#include "parser.h"
+
+ParseCache::ParseCache() {}
+
+Statement *ParseCache::find(int lineNumber) {
+    auto it = entries.find(lineNumber);
+    return it == entries.end() ? nullptr : it->second;
+}
+
+Statement *ParseCache::parse(int lineNumber, const std::string &code, EvaluationContext &context) {
+    Parser parser(code, nodes);
+    Statement *stmt = parser.parseStatement();
+    stmt->resolve(context);
+
+    // 这里不能整体释放：调用者可能正拿着其他行的语句
+    Statement *&slot = entries[lineNumber];
+    if (slot) deadLines++;
+    slot = stmt;
+    dirty = true;
+    return stmt;
+}
+
+void ParseCache::prefetch(const std::vector<int> &lineNumbers, const LineSource &codeAt, EvaluationContext &context) {
+    std::vector<int> missing; // lineNumbers 中未缓存的下标
+    for (int i = 0; i < (int)lineNumbers.size(); i++) {
+        if (!find(lineNumbers[i])) missing.push_back(i);
+    }
+    if (missing.empty()) return;
+
+    std::vector<Statement*> stmts = parseLinesParallel((int)missing.size(),
+        [&](int k) { return codeAt(missing[k]); }, nodes);
+
+    for (int k = 0; k < (int)missing.size(); k++) {
+        if (!stmts[k]) continue;
+        stmts[k]->resolve(context);
+        entries[lineNumbers[missing[k]]] = stmts[k];
+    }
+    dirty = true;
+}
+
+bool ParseCache::invalidate(int lineNumber) {
+    dirty = true;
+    if (entries.erase(lineNumber) == 0) return false;
+
+    deadLines++;
+    if (deadLines > MIN_COMPACT_LINES && deadLines > (int)entries.size()) {
+        clear();
+        return true;
+    }
+    return false;
+}
+
+void ParseCache::clear() {
+    entries.clear();
+    nodes.reset();
+    deadLines = 0;
+    dirty = true;
+}
@@ -0,0 +1,57 @@
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include "expression.h"
+#include "statement.h"
+#include "arena.h"
+#include "parallelparse.h"
+#include <map>
+#include <string>
+#include <vector>
+
+// === 解析缓存 ===
+// 按行号缓存解析（并已做符号解析）好的语句。
+// 只有编辑 / 删除某一行、LOAD、CLEAR 才会让缓存失效，
+// 重复 RUN 未修改的程序时不再做任何解析工作。
+// 所有语句分配在同一个 Arena 中：失效的行先留在 Arena 里，
+// 等失效的行比有效的行还多时整体释放，下次 RUN 重新解析全部行。
+class ParseCache {
+public:
+    ParseCache();
+
+    ParseCache(const ParseCache &) = delete;
+    ParseCache &operator=(const ParseCache &) = delete;
+
+    // 查找已缓存的语句，没有返回 nullptr
+    Statement *find(int lineNumber);
+
+    // 解析一行代码并放入缓存；语法错误时抛出异常，缓存保持不变
+    Statement *parse(int lineNumber, const std::string &code, EvaluationContext &context);
+
+    // 【新增】批量预解析：lineNumbers 中尚未缓存的行交给多个线程并行解析，
+    // 成功的行按行号顺序做符号解析后放入缓存。codeAt(i) 给出 lineNumbers[i] 的代码。
+    // 解析失败的行不缓存也不报错：调用者随后逐行 find / parse 时，
+    // 第一个出错的行会在 parse 中抛出与串行解析相同的错误
+    void prefetch(const std::vector<int> &lineNumbers, const LineSource &codeAt, EvaluationContext &context);
+
+    // 某一行被编辑或删除
+    // 注意：可能触发整体释放，调用时不能还有 Program 视图在使用缓存中的语句；
+    // 返回 true 表示发生了整体释放，之前取得的语句指针全部失效
+    bool invalidate(int lineNumber);
+    void clear(); // 整个程序被替换 (LOAD / CLEAR)
+
+    // 自上次 markClean() 以来缓存是否变化过（界面据此决定要不要重画语法树）
+    bool isDirty() const { return dirty; }
+    void markClean() { dirty = false; }
+    void markDirty() { dirty = true; } // 语法树显示方式变了，也需要重画
+
+private:
+    static const int MIN_COMPACT_LINES = 256;
+
+    std::map<int, Statement*> entries;
+    Arena nodes;
+    int deadLines = 0; // 已失效但还占着 Arena 的行数
+    bool dirty = true;
+};
+
+#endif // PARSECACHE_H
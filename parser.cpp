@@ -1,13 +1,21 @@
 #include "parser.h"
 #include <stdexcept>
 #include <iostream>
-
-Parser::Parser(std::string line) {
-    tokenizer = new Tokenizer(line);
-}
-
-Parser::~Parser() {
-    delete tokenizer;
+#include <climits>
+
+Parser::Parser(std::string_view line, Arena &arena) : tokenizer(line), arena(arena) {}
+
+// 运算符名字用静态常量保存，节点里的 string_view 不依赖源码的生命周期
+static std::string_view operatorName(TokenId id) {
+    switch (id) {
+    case TK_PLUS: return "+";
+    case TK_MINUS: return "-";
+    case TK_STAR: return "*";
+    case TK_SLASH: return "/";
+    case TK_MOD: return "MOD";
+    case TK_POW: return "**";
+    default: return "";
+    }
 }
 
 // 1. 最高层级：处理加减法 (+, -)
@@ -15,14 +23,14 @@ Parser::~Parser() {
 Expression* Parser::parseExpression() {
     Expression *lhs = parseTerm();
 
-    while (tokenizer->hasMoreTokens()) {
-        std::string token = tokenizer->peekToken();
+    while (tokenizer.hasMoreTokens()) {
+        TokenId id = tokenizer.peekToken().id;
 
-        if (token == "+" || token == "-") {
-            tokenizer->nextToken(); // 消耗掉操作符
+        if (id == TK_PLUS || id == TK_MINUS) {
+            Token token = tokenizer.nextToken(); // 消耗掉操作符
             Expression *rhs = parseTerm();
             // 组合成复合表达式，并作为新的左子树（左结合）
-            lhs = new CompoundExp(token, lhs, rhs);
+            lhs = CompoundExp::make(arena, operatorName(token.id), lhs, rhs);
         } else {
             break; // 遇到不是加减的符号（比如括号结束），停止
         }
@@ -35,13 +43,13 @@ Expression* Parser::parseExpression() {
 Expression* Parser::parseTerm() {
     Expression *lhs = parseFactor();
 
-    while (tokenizer->hasMoreTokens()) {
-        std::string token = tokenizer->peekToken();
+    while (tokenizer.hasMoreTokens()) {
+        TokenId id = tokenizer.peekToken().id;
 
-        if (token == "*" || token == "/" || token == "MOD") {
-            tokenizer->nextToken(); // 消耗掉操作符
+        if (id == TK_STAR || id == TK_SLASH || id == TK_MOD) {
+            Token token = tokenizer.nextToken(); // 消耗掉操作符
             Expression *rhs = parseFactor();
-            lhs = new CompoundExp(token, lhs, rhs);
+            lhs = CompoundExp::make(arena, operatorName(token.id), lhs, rhs);
         } else {
             break;
         }
@@ -55,17 +63,13 @@ Expression* Parser::parseTerm() {
 Expression* Parser::parseFactor() {
     Expression *lhs = parsePrimary();
 
-    if (tokenizer->hasMoreTokens()) {
-        std::string token = tokenizer->peekToken();
-
-        if (token == "**") {
-            tokenizer->nextToken(); // 消耗 **
+    if (tokenizer.peekToken().id == TK_POW) {
+        tokenizer.nextToken(); // 消耗 **
 
-            // 递归调用 parseFactor 而不是 parsePrimary，实现右结合
-            Expression *rhs = parseFactor();
+        // 递归调用 parseFactor 而不是 parsePrimary，实现右结合
+        Expression *rhs = parseFactor();
 
-            return new CompoundExp(token, lhs, rhs);
-        }
+        return CompoundExp::make(arena, operatorName(TK_POW), lhs, rhs);
     }
     return lhs;
 }
@@ -73,106 +77,144 @@ Expression* Parser::parseFactor() {
 // 4. 最底层：处理数字、变量、括号
 // 语法规则: Primary -> Number | Identifier | ( Expression )
 Expression* Parser::parsePrimary() {
-    std::string token = tokenizer->nextToken();
+    Token token = tokenizer.nextToken();
 
-    if (token == "") throw std::runtime_error("Unexpected end of line");
+    switch (token.kind) {
+    case TOKEN_END:
+        throw std::runtime_error("Unexpected end of line");
 
     // === 情况 A: 数字 ===
-    // 简单判断是否为数字（这里简化处理，假设 Tokenizer 切割正确）
-    if (isdigit(token[0]) || (token.size()>1 && token[0] == '-' && isdigit(token[1]))) {
-        return new ConstantExp(std::stoi(token));
-    }
+    case TOKEN_NUMBER:
+        return arena.make<ConstantExp>(parseNumber(token));
 
     // === 情况 B: 括号表达式 ===
-    if (token == "(") {
-        Expression *exp = parseExpression(); // 回到最高层递归
-
-        std::string next = tokenizer->nextToken();
-        if (next != ")") {
-            delete exp; // 防止内存泄漏
-            throw std::runtime_error("Missing closing parenthesis ')'");
+    case TOKEN_OPERATOR:
+        if (token.id == TK_LPAREN) {
+            Expression *exp = parseExpression(); // 回到最高层递归
+
+            if (tokenizer.nextToken().id != TK_RPAREN) {
+                throw std::runtime_error("Missing closing parenthesis ')'");
+            }
+            return exp;
         }
-        return exp;
+        break;
+
+    default:
+        break;
     }
 
     // === 情况 C: 变量 ===
-    // 剩下的都当做变量名处理
-    return new IdentifierExp(token);
+    // 剩下的都当做变量名处理（名字复制到 arena 中保存）
+    return arena.make<IdentifierExp>(arena.copyString(token.text));
+}
+
+int Parser::parseNumber(const Token &token) {
+    long long value = 0;
+    for (char c : token.text) {
+        value = value * 10 + (c - '0');
+        if (value > INT_MAX) {
+            throw std::runtime_error("Integer literal out of range: " + std::string(token.text));
+        }
+    }
+    return (int)value;
+}
+
+int Parser::parseLineNumber(const char *stmtName) {
+    Token token = tokenizer.nextToken();
+    if (token.kind != TOKEN_NUMBER) {
+        throw std::runtime_error(std::string("Syntax Error: Expect line number in ") + stmtName);
+    }
+    return parseNumber(token);
 }
 
 Statement* Parser::parseStatement() {
-    std::string token = tokenizer->peekToken();
+    Arena::Mark mark = arena.mark();
+    try {
+        Statement *stmt = parseStatementBody();
+
+        // 表达式优化（常量折叠 / 代数化简），新节点同样分配在 arena 中
+        Optimizer optimizer(arena);
+        stmt->optimize(optimizer);
+        return stmt;
+    }
+    catch (std::exception &) {
+        // 丢弃这条语句已经分配的节点，防止内存泄漏
+        arena.rollback(mark);
+        throw;
+    }
+}
+
+Statement* Parser::parseStatementBody() {
+    const Token &head = tokenizer.peekToken();
+    TokenId id = head.kind == TOKEN_KEYWORD ? head.id : TK_NONE;
 
+    switch (id) {
     // 1. REM 语句
-    if (token == "REM") {
-        tokenizer->nextToken(); // 消耗 REM
+    case TK_REM: {
+        tokenizer.nextToken(); // 消耗 REM
 
         std::string comment;
         // 循环读取这一行剩下的所有 token，拼回成句子
-        while (tokenizer->hasMoreTokens()) {
-            comment += tokenizer->nextToken() + " ";
+        while (tokenizer.hasMoreTokens()) {
+            comment += tokenizer.nextToken().text;
+            comment += ' ';
         }
 
         // 去掉末尾多余的一个空格
         if (!comment.empty()) comment.pop_back();
 
-        return new RemStmt(comment);
+        return arena.make<RemStmt>(arena.copyString(comment));
     }
 
     // 2. LET 语句 (LET var = exp)
-    else if (token == "LET") {
-        tokenizer->nextToken(); // 消耗 LET
-        std::string varName = tokenizer->nextToken();
-        std::string eq = tokenizer->nextToken();
-        if (eq != "=") throw std::runtime_error("Syntax Error: Expect '=' in LET");
+    case TK_LET: {
+        tokenizer.nextToken(); // 消耗 LET
+        std::string_view varName = arena.copyString(tokenizer.nextToken().text);
+        if (tokenizer.nextToken().id != TK_EQ) throw std::runtime_error("Syntax Error: Expect '=' in LET");
 
         Expression *exp = parseExpression();
-        return new LetStmt(varName, exp);
+        return arena.make<LetStmt>(varName, exp);
     }
 
     // 3. PRINT 语句 (PRINT exp)
-    else if (token == "PRINT") {
-        tokenizer->nextToken(); // 消耗 PRINT
+    case TK_PRINT: {
+        tokenizer.nextToken(); // 消耗 PRINT
         Expression *exp = parseExpression();
-        return new PrintStmt(exp);
+        return arena.make<PrintStmt>(exp);
     }
 
     // 4. INPUT 语句 (INPUT var)
-    else if (token == "INPUT") {
-        tokenizer->nextToken(); // 消耗 INPUT
-        std::string varName = tokenizer->nextToken();
-        return new InputStmt(varName);
+    case TK_INPUT: {
+        tokenizer.nextToken(); // 消耗 INPUT
+        std::string_view varName = arena.copyString(tokenizer.nextToken().text);
+        return arena.make<InputStmt>(varName);
     }
 
     // 5. GOTO 语句 (GOTO n)
-    else if (token == "GOTO") {
-        tokenizer->nextToken(); // 消耗 GOTO
-        std::string lineStr = tokenizer->nextToken();
-        return new GotoStmt(std::stoi(lineStr));
-    }
+    case TK_GOTO:
+        tokenizer.nextToken(); // 消耗 GOTO
+        return arena.make<GotoStmt>(parseLineNumber("GOTO"));
 
     // 6. IF 语句 (IF exp1 op exp2 THEN n)
-    else if (token == "IF") {
-        tokenizer->nextToken(); // 消耗 IF
+    case TK_IF: {
+        tokenizer.nextToken(); // 消耗 IF
 
         Expression *lhs = parseExpression();
-        std::string op = tokenizer->nextToken(); // <, >, =
+        std::string_view op = arena.copyString(tokenizer.nextToken().text); // <, >, =
         Expression *rhs = parseExpression();
 
-        std::string thenKwd = tokenizer->nextToken();
-        if (thenKwd != "THEN") throw std::runtime_error("Syntax Error: Expect 'THEN' in IF");
+        Token thenKwd = tokenizer.nextToken();
+        if (thenKwd.kind != TOKEN_KEYWORD || thenKwd.id != TK_THEN) throw std::runtime_error("Syntax Error: Expect 'THEN' in IF");
 
-        std::string lineStr = tokenizer->nextToken();
-        return new IfStmt(lhs, op, rhs, std::stoi(lineStr));
+        return arena.make<IfStmt>(lhs, op, rhs, parseLineNumber("IF"));
     }
 
     // 7. END 语句
-    else if (token == "END") {
-        tokenizer->nextToken();
-        return new EndStmt();
-    }
+    case TK_END:
+        tokenizer.nextToken();
+        return arena.make<EndStmt>();
 
-    else {
-        throw std::runtime_error("Unknown statement: " + token);
+    default:
+        throw std::runtime_error("Unknown statement: " + std::string(head.text));
     }
 }
@@ -4,25 +4,35 @@
 #include "expression.h"
 #include "tokenizer.h"
 #include "statement.h"
+#include "arena.h"
 #include <string>
 
 class Parser {
 public:
-    Parser(std::string line);
-    ~Parser();
+    // line 必须比 Parser 活得久（Token 直接指向它）
+    // 【修改】所有节点都分配在 arena 中，由 arena 的所有者统一释放
+    Parser(std::string_view line, Arena &arena);
+    Parser(std::string &&line, Arena &arena) = delete;
 
     // 主入口：解析并返回表达式树的根节点
-    // 调用者负责 delete 返回的指针
     Expression* parseExpression();
+    // 解析一整条语句并优化其中的表达式；
+    // 出错时抛出异常，并把这次解析在 arena 中分配的内存全部退回
     Statement* parseStatement();
 
 private:
-    Tokenizer *tokenizer; // 词法分析器实例
+    Tokenizer tokenizer; // 词法分析器实例
+    Arena &arena;
+
+    Statement* parseStatementBody();
 
     // 递归下降子函数
     Expression* parseTerm();     // 处理 *, /, MOD
     Expression* parseFactor();   // 处理 **
     Expression* parsePrimary();  // 处理 (), 数字, 变量
+
+    int parseNumber(const Token &token);       // 数字 Token -> int
+    int parseLineNumber(const char *stmtName); // GOTO / IF THEN 后面的行号
 };
 
 #endif // PARSER_H
@@ -0,0 +1,92 @@
+#include "profiledialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFile>
+#include <QMessageBox>
+
+// 数字列：按数值而不是按字符串排序
+class NumberItem : public QTableWidgetItem {
+public:
+    NumberItem(double value, int decimals) : QTableWidgetItem(QString::number(value, 'f', decimals)), value(value) {
+        setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    bool operator<(const QTableWidgetItem &other) const override {
+        return value < static_cast<const NumberItem &>(other).value;
+    }
+private:
+    double value;
+};
+
+ProfileDialog::ProfileDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Profile"));
+    resize(560, 420);
+
+    table = new QTableWidget(0, 6, this);
+    table->setHorizontalHeaderLabels({tr("Line"), tr("Hits"), tr("Total ms"), tr("INPUT ms"), tr("Exec ms"), tr("% Exec")});
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    table->verticalHeader()->hide();
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    summary = new QLabel(this);
+
+    QPushButton *exportButton = new QPushButton(tr("Export CSV..."), this);
+    QPushButton *closeButton = new QPushButton(tr("Close"), this);
+    connect(exportButton, &QPushButton::clicked, this, &ProfileDialog::exportCsv);
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::close);
+
+    QHBoxLayout *buttons = new QHBoxLayout;
+    buttons->addWidget(summary, 1);
+    buttons->addWidget(exportButton);
+    buttons->addWidget(closeButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(table);
+    layout->addLayout(buttons);
+}
+
+void ProfileDialog::setProfile(const Profiler &profiler)
+{
+    csv = profiler.toCsv();
+
+    std::vector<Profiler::LineStats> hot = profiler.hotLines();
+    long long execTotal = 0;
+    for (const Profiler::LineStats &s : hot) execTotal += s.execNs();
+
+    // 填表时关闭排序，否则每插入一格都会重新排序
+    table->setSortingEnabled(false);
+    table->setRowCount((int)hot.size());
+    for (int row = 0; row < (int)hot.size(); row++) {
+        const Profiler::LineStats &s = hot[row];
+        table->setItem(row, 0, new NumberItem(s.lineNumber, 0));
+        table->setItem(row, 1, new NumberItem((double)s.hits, 0));
+        table->setItem(row, 2, new NumberItem(s.totalNs / 1e6, 3));
+        table->setItem(row, 3, new NumberItem(s.inputNs / 1e6, 3));
+        table->setItem(row, 4, new NumberItem(s.execNs() / 1e6, 3));
+        table->setItem(row, 5, new NumberItem(execTotal > 0 ? 100.0 * s.execNs() / execTotal : 0, 1));
+    }
+    table->setSortingEnabled(true);
+    table->sortByColumn(2, Qt::DescendingOrder);
+
+    summary->setText(tr("%1 lines executed, %2 ms total")
+                     .arg((int)hot.size())
+                     .arg(profiler.totalNs() / 1e6, 0, 'f', 3));
+}
+
+void ProfileDialog::exportCsv()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export Profile"), "profile.csv", tr("CSV Files (*.csv)"));
+    if (fileName.isEmpty()) return;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QMessageBox::warning(this, tr("Export Profile"), tr("Cannot write %1").arg(fileName));
+        return;
+    }
+    file.write(csv.data(), (qint64)csv.size());
+}
@@ -0,0 +1,29 @@
+#ifndef PROFILEDIALOG_H
+#define PROFILEDIALOG_H
+
+#include "profiler.h"
+#include <QDialog>
+#include <QTableWidget>
+#include <QLabel>
+
+// 性能分析结果窗口：热点行表格（默认按总时间降序，点击表头可按其他列排序），
+// 可导出为 CSV。窗口不是模态的，运行下一次时直接刷新内容
+class ProfileDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    ProfileDialog(QWidget *parent = nullptr);
+
+    // 用一次运行的统计结果刷新表格（会复制一份，导出时使用）
+    void setProfile(const Profiler &profiler);
+
+private slots:
+    void exportCsv();
+
+private:
+    QTableWidget *table;
+    QLabel *summary;
+    std::string csv;
+};
+
+#endif // PROFILEDIALOG_H
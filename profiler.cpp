@@ -0,0 +1,57 @@
+#include "profiler.h"
+#include "program.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+void Profiler::reset(const Program &program) {
+    stats.assign(program.size(), LineStats());
+    for (int pc = 0; pc < program.size(); pc++) {
+        stats[pc].lineNumber = program.lineAt(pc);
+    }
+    current = 0;
+}
+
+std::vector<Profiler::LineStats> Profiler::hotLines() const {
+    std::vector<LineStats> hot;
+    for (const LineStats &s : stats) {
+        if (s.hits > 0) hot.push_back(s);
+    }
+    std::stable_sort(hot.begin(), hot.end(), [](const LineStats &a, const LineStats &b) {
+        if (a.totalNs != b.totalNs) return a.totalNs > b.totalNs;
+        return a.hits > b.hits;
+    });
+    return hot;
+}
+
+long long Profiler::totalNs() const {
+    long long total = 0;
+    for (const LineStats &s : stats) total += s.totalNs;
+    return total;
+}
+
+std::string Profiler::toCsv() const {
+    std::string csv = "line,hits,total_us,input_us,exec_us\n";
+    char buf[128];
+    for (const LineStats &s : stats) {
+        std::snprintf(buf, sizeof(buf), "%d,%lld,%.3f,%.3f,%.3f\n",
+                      s.lineNumber, s.hits, s.totalNs / 1000.0, s.inputNs / 1000.0, s.execNs() / 1000.0);
+        csv += buf;
+    }
+    return csv;
+}
+
+int ProfilingInputSource::readInt(const std::string &varName) {
+    if (!inner) throw std::runtime_error("No input handler defined");
+
+    Profiler::Clock::time_point begin = Profiler::Clock::now();
+    try {
+        int value = inner->readInt(varName);
+        profiler.addInputTime(std::chrono::duration_cast<std::chrono::nanoseconds>(Profiler::Clock::now() - begin).count());
+        return value;
+    }
+    catch (...) {
+        profiler.addInputTime(std::chrono::duration_cast<std::chrono::nanoseconds>(Profiler::Clock::now() - begin).count());
+        throw;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "io.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+class Program;
+
+// === 逐行性能分析器 ===
+// 打开分析时，Program::runProfiled 在每条语句执行前后计时，按行累计：
+//   - hits:    执行次数
+//   - totalNs: 花在 execute 里的总时间（包含等待 INPUT 的时间）
+//   - inputNs: 其中阻塞在 INPUT 上的时间（由 ProfilingInputSource 记录）
+// 不分析时走普通的 Program::run，执行循环里没有任何额外开销。
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct LineStats {
+        int lineNumber = 0;
+        long long hits = 0;
+        long long totalNs = 0;
+        long long inputNs = 0;
+
+        long long execNs() const { return totalNs - inputNs; } // 扣除 INPUT 等待后的执行时间
+    };
+
+    // 按程序的行准备计数器并清零，下标与 Program 的 pc 一致
+    void reset(const Program &program);
+
+    // 由执行循环调用
+    void enter(int pc) {
+        current = pc;
+        start = Clock::now();
+    }
+    void leave() {
+        LineStats &s = stats[current];
+        s.hits++;
+        s.totalNs += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+    void addInputTime(long long ns) { stats[current].inputNs += ns; }
+
+    // 按行号顺序的全部统计（包括没有执行过的行）
+    const std::vector<LineStats> &lines() const { return stats; }
+
+    // 执行过的行，按总时间从高到低排序（时间相同按执行次数）
+    std::vector<LineStats> hotLines() const;
+
+    long long totalNs() const;
+
+    // 导出为 CSV：line,hits,total_us,input_us,exec_us
+    std::string toCsv() const;
+
+private:
+    std::vector<LineStats> stats;
+    int current = 0;
+    Clock::time_point start;
+};
+
+// 包装另一个 InputSource，把阻塞在 INPUT 上的时间记到当前行
+class ProfilingInputSource : public InputSource {
+public:
+    ProfilingInputSource(InputSource *inner, Profiler &profiler) : inner(inner), profiler(profiler) {}
+    virtual int readInt(const std::string &varName) override;
+
+private:
+    InputSource *inner;
+    Profiler &profiler;
+};
+
+#endif // PROFILER_H
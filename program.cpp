@@ -0,0 +1,190 @@
+#include "program.h"
+#include "parser.h"
+#include "flatast.h"
+#include <algorithm> // std::lower_bound
+#include <climits>
+#include <stdexcept>
+#include <string>
+
+Program::Program() {}
+Program::~Program() {}
+
+void Program::add(int lineNumber, Statement *stmt) {
+    flatCache.reset();
+    lines.push_back(lineNumber);
+    stmts.push_back(stmt);
+    if (!pendingCode.empty()) pendingCode.emplace_back();
+}
+
+void Program::addLazy(int lineNumber, std::string code) {
+    flatCache.reset();
+    pendingCode.resize(stmts.size()); // 之前 add 的行没有待解析的源码
+    lines.push_back(lineNumber);
+    stmts.push_back(nullptr);
+    pendingCode.push_back(std::move(code));
+    unparsed++;
+}
+
+Statement *Program::parseLazy(int pc, EvaluationContext &context) {
+    Statement *stmt;
+    try {
+        Parser parser(pendingCode[pc], nodes);
+        stmt = parser.parseStatement();
+        stmt->resolve(context);
+        if (stmt->type() == GOTO_STMT || stmt->type() == IF_STMT) {
+            int target = indexOf(stmt->getLineNumber());
+            if (target < 0) {
+                throw std::runtime_error("Line number not found: " + std::to_string(stmt->getLineNumber()));
+            }
+            stmt->setTarget(target);
+        }
+    }
+    catch (std::exception &e) {
+        throw LazySyntaxError(lines[pc], e.what());
+    }
+
+    stmts[pc] = stmt;
+    std::string().swap(pendingCode[pc]); // 节点里的字符串已经复制到 arena
+    unparsed--;
+    return stmt;
+}
+
+int Program::indexOf(int lineNumber) const {
+    // lines 有序，二分查找
+    auto it = std::lower_bound(lines.begin(), lines.end(), lineNumber);
+    if (it == lines.end() || *it != lineNumber) return -1;
+    return (int)(it - lines.begin());
+}
+
+void Program::link() {
+    flatCache.reset();
+    for (Statement *stmt : stmts) {
+        if (!stmt) continue;
+        if (stmt->type() != GOTO_STMT && stmt->type() != IF_STMT) continue;
+
+        int target = indexOf(stmt->getLineNumber());
+        if (target < 0) {
+            throw std::runtime_error("Line number not found: " + std::to_string(stmt->getLineNumber()));
+        }
+        stmt->setTarget(target);
+    }
+}
+
+long long Program::run(EvaluationContext &context) {
+    if (isLazy()) return runLazy(context);
+
+    int pc = 0;
+    int n = size();
+    long long executed = 0;
+
+    // 没有限制时 checkpoint 为最大值，循环里的比较永远不成立
+    ExecutionBudget *budget = context.budget();
+    long long checkpoint = budget ? budget->checkpoint() : LLONG_MAX;
+
+    try {
+        while (pc < n) {
+            if (executed >= checkpoint) {
+                budget->check(executed, 1);
+                checkpoint = budget->checkpoint();
+            }
+
+            int next = stmts[pc]->execute(context);
+            executed++;
+
+            if (next == Statement::NEXT_PC) pc++;       // 正常执行下一行
+            else if (next == Statement::HALT_PC) break; // END
+            else {                                      // GOTO / IF 跳转
+                pc = next;
+                if (context.stopRequested()) throw ExecutionStopped();
+            }
+        }
+    }
+    catch (LimitExceeded &e) {
+        e.setPosition(lines[pc], executed);
+        throw;
+    }
+    return executed;
+}
+
+long long Program::runLazy(EvaluationContext &context) {
+    int pc = 0;
+    int n = size();
+    long long executed = 0;
+
+    ExecutionBudget *budget = context.budget();
+    long long checkpoint = budget ? budget->checkpoint() : LLONG_MAX;
+
+    try {
+        while (pc < n) {
+            if (executed >= checkpoint) {
+                budget->check(executed, 1);
+                checkpoint = budget->checkpoint();
+            }
+
+            int next = ensure(pc, context)->execute(context);
+            executed++;
+
+            if (next == Statement::NEXT_PC) pc++;       // 正常执行下一行
+            else if (next == Statement::HALT_PC) break; // END
+            else {                                      // GOTO / IF 跳转
+                pc = next;
+                if (context.stopRequested()) throw ExecutionStopped();
+            }
+        }
+    }
+    catch (LimitExceeded &e) {
+        e.setPosition(lines[pc], executed);
+        throw;
+    }
+    return executed;
+}
+
+long long Program::runProfiled(EvaluationContext &context, Profiler &profiler) {
+    int pc = 0;
+    int n = size();
+    long long executed = 0;
+
+    ExecutionBudget *budget = context.budget();
+    long long checkpoint = budget ? budget->checkpoint() : LLONG_MAX;
+
+    try {
+        while (pc < n) {
+            if (executed >= checkpoint) {
+                budget->check(executed, 1);
+                checkpoint = budget->checkpoint();
+            }
+
+            profiler.enter(pc);
+            int next;
+            try {
+                next = ensure(pc, context)->execute(context);
+            }
+            catch (...) {
+                profiler.leave(); // 出错的那一行也计入
+                throw;
+            }
+            profiler.leave();
+            executed++;
+
+            if (next == Statement::NEXT_PC) pc++;
+            else if (next == Statement::HALT_PC) break;
+            else {
+                pc = next;
+                if (context.stopRequested()) throw ExecutionStopped();
+            }
+        }
+    }
+    catch (LimitExceeded &e) {
+        e.setPosition(lines[pc], executed);
+        throw;
+    }
+    return executed;
+}
+
+const FlatProgram &Program::flat() {
+    if (!flatCache) {
+        flatCache = std::make_unique<FlatProgram>();
+        flatCache->compile(*this);
+    }
+    return *flatCache;
+}
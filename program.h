@@ -0,0 +1,98 @@
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include "statement.h"
+#include "arena.h"
+#include "profiler.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class FlatProgram;
+
+// 【新增】延迟解析的程序在执行到某一行时才发现的语法错误（包括 GOTO / IF 的目标行不存在）
+class LazySyntaxError : public std::runtime_error {
+public:
+    LazySyntaxError(int lineNumber, const std::string &message)
+        : std::runtime_error(message + " (line " + std::to_string(lineNumber) + ")"), line(lineNumber) {}
+    int lineNumber() const { return line; }
+private:
+    int line;
+};
+
+// === 解析好的程序 ===
+// 语句按行号升序存放在稠密数组里，下标即“程序计数器” pc。
+// GOTO / IF 的目标行号在 link() 中一次性解析成下标，执行时直接跳转。
+// 语句可以分配在 Program 自己的 arena() 中（随 Program 一起释放），
+// 也可以归别处（例如 ParseCache）管理，此时 Program 只是按行号排好的视图。
+// 【新增】延迟解析：addLazy 只登记行号和源码，语句在第一次执行到时才解析（见 ensure），
+// 尚未解析的行 at() 返回 nullptr。
+class Program {
+public:
+    Program();
+    ~Program();
+
+    Program(const Program &) = delete;
+    Program &operator=(const Program &) = delete;
+
+    // 追加一条语句，行号必须比已有的都大
+    void add(int lineNumber, Statement *stmt);
+
+    // 【新增】追加一行尚未解析的源码，行号必须比已有的都大
+    void addLazy(int lineNumber, std::string code);
+
+    // 解析所有跳转目标；目标行不存在时抛出 std::runtime_error，
+    // 这样错误在执行开始之前就能报告。尚未解析的行跳过，由 ensure 检查
+    void link();
+
+    // 【新增】还有没解析的行
+    bool isLazy() const { return unparsed > 0; }
+
+    // 【新增】第 pc 行的语句，尚未解析时现在解析、做符号解析，并按已知的行号检查跳转目标；
+    // 出错时抛出 LazySyntaxError，这一行保持未解析
+    Statement *ensure(int pc, EvaluationContext &context) {
+        Statement *stmt = stmts[pc];
+        return stmt ? stmt : parseLazy(pc, context);
+    }
+
+    // 树遍历执行（参考引擎），返回执行过的语句条数。
+    // 还有没解析的行时交给 runLazy，全部解析好的程序走不带 ensure 的循环
+    long long run(EvaluationContext &context);
+
+    // 【新增】带逐行计时的树遍历；profiler 需要先 reset(*this)。
+    // 与 run 分开写，保证不分析时执行循环没有额外开销（计时的开销远大于 ensure，这里直接用 ensure）
+    long long runProfiled(EvaluationContext &context, Profiler &profiler);
+
+    int size() const { return (int)stmts.size(); }
+    int lineAt(int pc) const { return lines[pc]; }
+    Statement *at(int pc) const { return stmts[pc]; }
+
+    // 行号 -> 下标，不存在返回 -1
+    int indexOf(int lineNumber) const;
+
+    // 解析本程序时用来分配语法树节点的 Arena
+    Arena &arena() { return nodes; }
+
+    // 【新增】扁平表示（见 flatast.h）：第一次用到时转换，之后重复执行不再转换；
+    // add / addLazy / link 改变程序时丢弃。只能用于全部解析好并已 link 的程序
+    const FlatProgram &flat();
+
+private:
+    std::vector<int> lines;
+    std::vector<Statement*> stmts;
+    Arena nodes;
+
+    // 延迟解析：第 pc 行的源码（解析后释放），以及还没解析的行数
+    std::vector<std::string> pendingCode;
+    int unparsed = 0;
+
+    std::unique_ptr<FlatProgram> flatCache;
+
+    Statement *parseLazy(int pc, EvaluationContext &context);
+
+    // 与 run 相同，但每条语句执行前经过 ensure
+    long long runLazy(EvaluationContext &context);
+};
+
+#endif // PROGRAM_H
@@ -0,0 +1,75 @@
+#include "programcodemodel.h"
+#include <algorithm>
+
+ProgramCodeModel::ProgramCodeModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int ProgramCodeModel::lowerBound(int lineNumber) const
+{
+    return (int)(std::lower_bound(lineNumbers.begin(), lineNumbers.end(), lineNumber) - lineNumbers.begin());
+}
+
+void ProgramCodeModel::setLine(int lineNumber, const QString &code)
+{
+    int row = lowerBound(lineNumber);
+
+    if (row < size() && lineNumbers[row] == lineNumber) {
+        // 已有的行：原地替换，只通知这一行
+        codes[row] = code;
+        QModelIndex changed = index(row);
+        emit dataChanged(changed, changed, {Qt::DisplayRole});
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), row, row);
+    lineNumbers.insert(lineNumbers.begin() + row, lineNumber);
+    codes.insert(codes.begin() + row, code);
+    endInsertRows();
+}
+
+void ProgramCodeModel::removeLine(int lineNumber)
+{
+    int row = lowerBound(lineNumber);
+    if (row >= size() || lineNumbers[row] != lineNumber) return;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    lineNumbers.erase(lineNumbers.begin() + row);
+    codes.erase(codes.begin() + row);
+    endRemoveRows();
+}
+
+void ProgramCodeModel::load(const std::vector<SourceLine> &lines)
+{
+    beginResetModel();
+    lineNumbers.clear();
+    codes.clear();
+    lineNumbers.reserve(lines.size());
+    codes.reserve(lines.size());
+    for (const SourceLine &line : lines) {
+        lineNumbers.push_back(line.lineNumber);
+        codes.push_back(QString::fromUtf8(line.code.data(), (int)line.code.size()));
+    }
+    endResetModel();
+}
+
+void ProgramCodeModel::clear()
+{
+    beginResetModel();
+    lineNumbers.clear();
+    codes.clear();
+    endResetModel();
+}
+
+int ProgramCodeModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : size();
+}
+
+QVariant ProgramCodeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+    // 显示格式： "10 LET A = 1"
+    return QString::number(lineNumbers[index.row()]) + " " + codes[index.row()];
+}
@@ -0,0 +1,44 @@
+#ifndef PROGRAMCODEMODEL_H
+#define PROGRAMCODEMODEL_H
+
+#include "interpreter.h"
+#include <QAbstractListModel>
+#include <QString>
+#include <vector>
+
+// === 程序代码 ===
+// 按行号升序保存 BASIC 程序的每一行，同时作为代码窗口 (CodeDisplay) 的模型。
+// 编辑一行只插入 / 替换 / 删除对应的那一行（二分查找定位），视图只更新受影响的行；
+// LOAD / CLEAR 这种整体替换只发一次 reset。
+class ProgramCodeModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    ProgramCodeModel(QObject *parent = nullptr);
+
+    // 插入或替换一行
+    void setLine(int lineNumber, const QString &code);
+    // 删除一行；行不存在时什么也不做
+    void removeLine(int lineNumber);
+
+    // 整体替换为 lines（必须按行号升序、无重复，scanSource 的结果即满足）
+    void load(const std::vector<SourceLine> &lines);
+    void clear();
+
+    int size() const { return (int)lineNumbers.size(); }
+    bool empty() const { return lineNumbers.empty(); }
+    int lineAt(int row) const { return lineNumbers[row]; }
+    const QString &codeAt(int row) const { return codes[row]; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    std::vector<int> lineNumbers;
+    std::vector<QString> codes;
+
+    // 第一个行号 >= lineNumber 的行
+    int lowerBound(int lineNumber) const;
+};
+
+#endif // PROGRAMCODEMODEL_H
@@ -0,0 +1,162 @@
+#include "programrunner.h"
+#include "program.h"
+#include <chrono>
+
+ProgramRunner::ProgramRunner(EvaluationContext &context, OutputSink &uiSink, QObject *parent)
+    : QObject(parent)
+    , context(context)
+    , uiSink(uiSink)
+    , queueSink(*this)
+    , handoffInput(*this)
+    , output(QUEUE_CAPACITY)
+{
+    context.setIO(&queueSink, &handoffInput);
+    context.setStopFlag(&stopFlag);
+
+    drainTimer.setInterval(DRAIN_INTERVAL_MS);
+    connect(&drainTimer, &QTimer::timeout, this, &ProgramRunner::drainOutput);
+}
+
+ProgramRunner::~ProgramRunner()
+{
+    if (thread) {
+        stop();
+        thread->wait();
+        delete thread;
+    }
+}
+
+void ProgramRunner::start(std::function<void()> job)
+{
+    if (thread) return;
+
+    output.clear();
+    stopFlag.store(false);
+    error.clear();
+    errorKind = RUNTIME_ERROR;
+    stopped = false;
+    {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        waitingForInput = false;
+        hasInput = false;
+    }
+
+    thread = QThread::create([this, job]() {
+        try {
+            job();
+        }
+        catch (ExecutionStopped &) {
+            stopped = true;
+        }
+        catch (LazySyntaxError &e) {
+            error = e.what();
+            errorKind = SYNTAX_ERROR;
+        }
+        catch (LimitExceeded &e) {
+            error = e.what();
+            errorKind = LIMIT_ERROR;
+        }
+        catch (std::exception &e) {
+            error = e.what();
+        }
+    });
+    // finished 在工作线程中发出，排队到本对象所在的界面线程处理
+    connect(thread, &QThread::finished, this, &ProgramRunner::onThreadFinished, Qt::QueuedConnection);
+    drainTimer.start();
+    thread->start();
+}
+
+void ProgramRunner::stop()
+{
+    stopFlag.store(true);
+    // 唤醒可能正在等待 INPUT 的工作线程
+    std::lock_guard<std::mutex> lock(inputMutex);
+    inputReady.notify_all();
+}
+
+bool ProgramRunner::isWaitingForInput()
+{
+    std::lock_guard<std::mutex> lock(inputMutex);
+    return waitingForInput;
+}
+
+void ProgramRunner::provideInput(int value)
+{
+    std::lock_guard<std::mutex> lock(inputMutex);
+    if (!waitingForInput) return;
+    inputValue = value;
+    hasInput = true;
+    inputReady.notify_all();
+}
+
+void ProgramRunner::drainOutput()
+{
+    // 工作线程一直在输出时（例如 10 PRINT 1 : 20 GOTO 10）队列永远取不空，
+    // 不限制行数的话界面线程回不到事件循环，窗口卡死，STOP 也点不了
+    std::string line;
+    for (int i = 0; i < DRAIN_BATCH; i++) {
+        if (!output.pop(line)) return;
+        uiSink.writeLine(line);
+    }
+    // 定时器和补排的这一次可能交替调用 drainOutput，最多只留一个补排
+    if (!drainScheduled) {
+        drainScheduled = true;
+        QTimer::singleShot(0, this, [this]() {
+            drainScheduled = false;
+            drainOutput();
+        });
+    }
+}
+
+void ProgramRunner::drainAll()
+{
+    std::string line;
+    while (output.pop(line)) uiSink.writeLine(line);
+}
+
+void ProgramRunner::onThreadFinished()
+{
+    drainTimer.stop();
+    thread->wait();
+    thread->deleteLater();
+    thread = nullptr;
+
+    drainAll();
+    uiSink.flush();
+    emit finished(QString::fromStdString(error), errorKind, stopped);
+}
+
+void ProgramRunner::QueueSink::writeLine(const std::string &line) {
+    std::string copy = line;
+    // 队列满：界面线程来不及显示，生产者让出 CPU 等待，期间仍响应停止
+    int spins = 0;
+    while (!runner.output.push(std::move(copy))) {
+        if (runner.stopFlag.load(std::memory_order_relaxed)) throw ExecutionStopped();
+        if (++spins < 64) QThread::yieldCurrentThread();
+        else QThread::msleep(1);
+    }
+}
+
+int ProgramRunner::HandoffInput::readInt(const std::string &varName) {
+    {
+        std::lock_guard<std::mutex> lock(runner.inputMutex);
+        runner.waitingForInput = true;
+        runner.hasInput = false;
+    }
+
+    // 在界面线程中发出请求：此前写入队列的输出会先于提示显示
+    QString name = QString::fromStdString(varName);
+    QMetaObject::invokeMethod(&runner, [this, name]() {
+        runner.drainAll(); // 工作线程正阻塞在 INPUT 上，不会再输出
+        emit runner.inputRequested(name);
+    }, Qt::QueuedConnection);
+
+    std::unique_lock<std::mutex> lock(runner.inputMutex);
+    runner.inputReady.wait(lock, [this]() {
+        return runner.hasInput || runner.stopFlag.load();
+    });
+    runner.waitingForInput = false;
+    if (!runner.hasInput) throw ExecutionStopped();
+    runner.hasInput = false;
+    return runner.inputValue;
+}
@@ -0,0 +1,108 @@
+#ifndef PROGRAMRUNNER_H
+#define PROGRAMRUNNER_H
+
+#include "expression.h"
+#include "io.h"
+#include "spscqueue.h"
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+
+// === 在工作线程中执行 BASIC 程序 ===
+// 界面线程只负责显示：
+//   - PRINT 的输出经无锁队列 (SpscQueue) 传回，界面线程定时取出交给 uiSink
+//   - INPUT 时工作线程发出 inputRequested 并阻塞等待，界面线程拿到输入后调用 provideInput
+//   - stop() 置位停止标志：执行引擎在下一次跳转时、INPUT / 输出等待中都会立刻退出
+// 运行期间 context 只能由工作线程访问。
+class ProgramRunner : public QObject {
+    Q_OBJECT
+
+public:
+    // 出错的种类，决定界面上的前缀（与命令行版本的措辞一致）
+    enum ErrorKind {
+        RUNTIME_ERROR, // "Runtime Error: "
+        SYNTAX_ERROR,  // "Syntax Error: "：延迟解析时执行到某一行才发现的语法错误 (LazySyntaxError)
+        LIMIT_ERROR    // "Limit Error: "：超出 LIMIT 设置的限制 (LimitExceeded)
+    };
+
+    // 构造时把 context 的输入输出接到本对象上，之后所有执行都要经过 start()
+    ProgramRunner(EvaluationContext &context, OutputSink &uiSink, QObject *parent = nullptr);
+    ~ProgramRunner();
+
+    // 在工作线程中执行 job；正在运行时忽略
+    void start(std::function<void()> job);
+
+    // 请求停止，立即返回；真正结束时仍会发出 finished
+    void stop();
+
+    bool isRunning() const { return thread != nullptr; }
+    bool isWaitingForInput();
+
+    // 把界面输入的值交给正在等待的 INPUT
+    void provideInput(int value);
+
+    // 把工作线程已经输出的行交给 uiSink，每次最多 DRAIN_BATCH 行；
+    // 还有剩余时安排在事件循环处理完其他事件（例如 STOP）之后继续
+    void drainOutput();
+
+signals:
+    void inputRequested(const QString &varName);
+    // error 为空表示正常结束，否则 kind 是这一次 job 的出错种类；stopped 表示被 stop() 打断
+    void finished(const QString &error, ProgramRunner::ErrorKind kind, bool stopped);
+
+private:
+    // 工作线程一侧的输出端口：写入无锁队列，队列满时等待界面线程取走
+    class QueueSink : public OutputSink {
+    public:
+        QueueSink(ProgramRunner &runner) : runner(runner) {}
+        virtual void writeLine(const std::string &line) override;
+    private:
+        ProgramRunner &runner;
+    };
+
+    // 工作线程一侧的输入端口：请求界面线程输入，并阻塞到有值或被停止
+    class HandoffInput : public InputSource {
+    public:
+        HandoffInput(ProgramRunner &runner) : runner(runner) {}
+        virtual int readInt(const std::string &varName) override;
+    private:
+        ProgramRunner &runner;
+    };
+
+    static const int QUEUE_CAPACITY = 1 << 16;
+    static const int DRAIN_INTERVAL_MS = 16;
+    static const int DRAIN_BATCH = 1024;
+
+    EvaluationContext &context;
+    OutputSink &uiSink;
+    QueueSink queueSink;
+    HandoffInput handoffInput;
+
+    SpscQueue<std::string> output;
+    std::atomic<bool> stopFlag{false};
+    QThread *thread = nullptr;
+    QTimer drainTimer;
+    bool drainScheduled = false;
+
+    std::mutex inputMutex;
+    std::condition_variable inputReady;
+    bool waitingForInput = false;
+    bool hasInput = false;
+    int inputValue = 0;
+
+    // 由工作线程写、finished 之后界面线程读
+    std::string error;
+    ErrorKind errorKind = RUNTIME_ERROR;
+    bool stopped = false;
+
+    void onThreadFinished();
+    // 取出队列中的全部行：只能在工作线程不再输出时（已结束或阻塞在 INPUT 上）调用
+    void drainAll();
+};
+
+#endif // PROGRAMRUNNER_H
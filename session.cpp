@@ -0,0 +1,169 @@
+#include "session.h"
+#include "interpreter.h"
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+static const char *HEADER = "MINIBASIC-SESSION 1";
+
+// ==========================================================
+// SessionLog 实现
+// ==========================================================
+
+int SessionLog::count(EventKind kind) const {
+    int n = 0;
+    for (const Event &e : log) {
+        if (e.kind == kind) n++;
+    }
+    return n;
+}
+
+std::vector<int> SessionLog::inputs() const {
+    std::vector<int> values;
+    for (const Event &e : log) {
+        if (e.kind == INPUT_EVENT) values.push_back(std::stoi(e.text));
+    }
+    return values;
+}
+
+void SessionLog::captureVariables(const EvaluationContext &context) {
+    initial.clear();
+    for (int slot = 0; slot < context.slotCount(); slot++) {
+        if (context.isSlotDefined(slot)) initial.push_back({context.slotName(slot), context.getSlot(slot)});
+    }
+}
+
+void SessionLog::restoreVariables(EvaluationContext &context) const {
+    context.clear();
+    for (const Variable &v : initial) context.setValue(v.name, v.value);
+}
+
+std::string SessionLog::toText() const {
+    std::string text = HEADER;
+    text += '\n';
+    for (const Variable &v : initial) text += "V " + v.name + " " + std::to_string(v.value) + "\n";
+    for (const Event &e : log) {
+        text += (char)e.kind;
+        text += ' ';
+        text += e.text;
+        text += '\n';
+    }
+    return text;
+}
+
+SessionLog SessionLog::fromText(const std::string &text) {
+    SessionLog session;
+    size_t begin = 0;
+    int lineNumber = 0;
+    while (begin < text.size()) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string::npos) end = text.size();
+        std::string line = text.substr(begin, end - begin);
+        begin = end + 1;
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        if (lineNumber == 1) {
+            if (line != HEADER) throw std::runtime_error("Not a session log");
+            continue;
+        }
+        if (line.empty()) continue;
+
+        std::string content = line.size() > 2 ? line.substr(2) : "";
+        bool ok = line.size() >= 2 && line[1] == ' ';
+        if (ok && line[0] == 'V') {
+            // 起始变量 "V <名字> <值>"，名字不含空格
+            size_t space = content.find(' ');
+            int value = space == std::string::npos ? 0 : parseIntLine(content.substr(space + 1), ok);
+            if (space == std::string::npos || space == 0) ok = false;
+            if (ok) session.addVariable(content.substr(0, space), value);
+        }
+        else if (ok && line[0] == INPUT_EVENT) {
+            int value = parseIntLine(content, ok);
+            if (ok) session.addInput(value);
+        }
+        else if (ok && line[0] == OUTPUT_EVENT) session.addOutput(content);
+        else if (ok && line[0] == ERROR_EVENT) session.addError(content);
+        else ok = false;
+
+        if (!ok) throw std::runtime_error("Bad session log line " + std::to_string(lineNumber) + ": " + line);
+    }
+    if (lineNumber == 0) throw std::runtime_error("Not a session log");
+    return session;
+}
+
+void SessionLog::save(const std::string &path) const {
+    std::ofstream out(path, std::ios::binary);
+    std::string text = toText();
+    out.write(text.data(), (std::streamsize)text.size());
+    if (!out) throw std::runtime_error("Cannot write " + path);
+}
+
+SessionLog SessionLog::load(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open " + path);
+    return fromText(std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()));
+}
+
+// ==========================================================
+// 记录端口
+// ==========================================================
+
+int RecordingInputSource::readInt(const std::string &varName) {
+    int value = inner->readInt(varName);
+    log.addInput(value);
+    return value;
+}
+
+void RecordingSink::writeLine(const std::string &line) {
+    log.addOutput(line);
+    if (inner) inner->writeLine(line);
+}
+
+// ==========================================================
+// 回放
+// ==========================================================
+
+static std::string describe(const std::vector<SessionLog::Event> &events, size_t i) {
+    if (i >= events.size()) return "end of session";
+    return std::string(1, (char)events[i].kind) + " " + events[i].text;
+}
+
+ReplayResult replaySession(Program &program, EvaluationContext &context, ExecEngine engine,
+                           const SessionLog &log, OutputSink *echo) {
+    ScriptedInputSource feed;
+    for (int value : log.inputs()) feed.push(value);
+
+    SessionLog actual;
+    RecordingInputSource input(&feed, actual);
+    RecordingSink output(echo, actual);
+    // 与界面里之前的 RUN 或立即执行留下的变量无关
+    log.restoreVariables(context);
+    {
+        ScopedIO io(context, &output, &input);
+        try {
+            executeProgram(program, context, engine);
+        }
+        catch (ExecutionStopped &) {
+            throw;
+        }
+        catch (std::exception &e) {
+            actual.addError(e.what());
+        }
+    }
+
+    ReplayResult result;
+    result.inputs = actual.count(SessionLog::INPUT_EVENT);
+    result.outputs = actual.count(SessionLog::OUTPUT_EVENT);
+
+    const std::vector<SessionLog::Event> &want = log.events();
+    const std::vector<SessionLog::Event> &got = actual.events();
+    size_t i = 0;
+    while (i < want.size() && i < got.size() && want[i] == got[i]) i++;
+    if (i < want.size() || i < got.size()) {
+        result.matched = false;
+        result.mismatch = "event " + std::to_string(i + 1) + ": expected \"" + describe(want, i) +
+                          "\", got \"" + describe(got, i) + "\"";
+    }
+    return result;
+}
@@ -0,0 +1,124 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "expression.h"
+#include "io.h"
+#include "program.h"
+#include "bytecode.h"
+#include <string>
+#include <vector>
+
+// === 会话记录 ===
+// 按发生顺序记下一次运行中 INPUT 读到的每个值、PRINT 的每一行，以及结束时的错误。
+// 界面在多次 RUN 之间保留变量，所以运行开始时已经赋值的变量也要记下，回放前恢复。
+// 文本格式：第一行 "MINIBASIC-SESSION 1"，之后是起始变量 "V <名字> <值>"，再之后每个事件一行 "<种类> <内容>"，例如
+//   V A 3
+//   I 5
+//   O 25
+//   E Division by zero
+class SessionLog {
+public:
+    enum EventKind : char { INPUT_EVENT = 'I', OUTPUT_EVENT = 'O', ERROR_EVENT = 'E' };
+
+    struct Event {
+        EventKind kind;
+        std::string text;
+
+        bool operator==(const Event &other) const { return kind == other.kind && text == other.text; }
+    };
+
+    // 运行开始时已经赋值的变量，不参与事件比较
+    struct Variable {
+        std::string name;
+        int value;
+    };
+
+    void addInput(int value) { log.push_back({INPUT_EVENT, std::to_string(value)}); }
+    void addOutput(const std::string &line) { log.push_back({OUTPUT_EVENT, line}); }
+    void addError(const std::string &message) { log.push_back({ERROR_EVENT, message}); }
+    void addVariable(const std::string &name, int value) { initial.push_back({name, value}); }
+    void clear() {
+        log.clear();
+        initial.clear();
+    }
+
+    // 记下 context 中已经赋值的变量，作为这次运行的起始状态（在运行开始前调用）
+    void captureVariables(const EvaluationContext &context);
+    // 把 context 的变量恢复成起始状态：先全部清空，再设置记下的变量
+    void restoreVariables(EvaluationContext &context) const;
+
+    const std::vector<Variable> &variables() const { return initial; }
+    const std::vector<Event> &events() const { return log; }
+    int count(EventKind kind) const;
+
+    // 按顺序取出所有输入值，回放时交给 ScriptedInputSource
+    std::vector<int> inputs() const;
+
+    std::string toText() const;
+    // 格式不对时抛出 std::runtime_error
+    static SessionLog fromText(const std::string &text);
+
+    // 读写文件失败时抛出 std::runtime_error
+    void save(const std::string &path) const;
+    static SessionLog load(const std::string &path);
+
+private:
+    std::vector<Event> log;
+    std::vector<Variable> initial; // 运行开始时已经赋值的变量
+};
+
+// 把经过的输入记到 log 中，再原样返回
+class RecordingInputSource : public InputSource {
+public:
+    RecordingInputSource(InputSource *inner, SessionLog &log) : inner(inner), log(log) {}
+    virtual int readInt(const std::string &varName) override;
+private:
+    InputSource *inner;
+    SessionLog &log;
+};
+
+// 把经过的输出记到 log 中，再交给 inner（可以为 nullptr，只记录不显示）
+class RecordingSink : public OutputSink {
+public:
+    RecordingSink(OutputSink *inner, SessionLog &log) : inner(inner), log(log) {}
+    virtual void writeLine(const std::string &line) override;
+    virtual void flush() override { if (inner) inner->flush(); }
+private:
+    OutputSink *inner;
+    SessionLog &log;
+};
+
+// 在作用域内替换 context 的输入输出端口，离开时（包括异常）恢复原来的
+class ScopedIO {
+public:
+    ScopedIO(EvaluationContext &context, OutputSink *out, InputSource *in)
+        : context(context), savedOut(context.outputSink()), savedIn(context.inputSource()) {
+        context.setIO(out, in);
+    }
+    ~ScopedIO() { context.setIO(savedOut, savedIn); }
+
+    ScopedIO(const ScopedIO &) = delete;
+    ScopedIO &operator=(const ScopedIO &) = delete;
+
+private:
+    EvaluationContext &context;
+    OutputSink *savedOut;
+    InputSource *savedIn;
+};
+
+// === 回放 ===
+struct ReplayResult {
+    bool matched = true;
+    std::string mismatch;   // 第一处不同，matched 时为空
+    int inputs = 0;         // 这次运行读入的值
+    int outputs = 0;        // 这次运行输出的行
+};
+
+// 先把 context 的变量恢复成记录开始时的状态，再用 log 中记录的输入全速运行程序，
+// 不等待任何人输入，把这次运行的事件与记录逐条比较。
+// echo 不为空时同时把输出写给它。运行时错误作为事件参与比较，不会抛出；
+// 停止 (ExecutionStopped) 照常抛出
+ReplayResult replaySession(Program &program, EvaluationContext &context, ExecEngine engine,
+                           const SessionLog &log, OutputSink *echo = nullptr);
+
+#endif // SESSION_H
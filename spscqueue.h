@@ -0,0 +1,58 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// === 单生产者单消费者无锁队列 ===
+// 固定容量的环形缓冲区：只有一个线程 push、一个线程 pop 时不需要加锁。
+// head 只由消费者写，tail 只由生产者写，各自用 acquire / release 发布对方需要看到的数据。
+// 容量向上取整为 2 的幂，下标用掩码回绕。
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity = 4096) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    // 生产者调用；队列满时返回 false，value 保持不变
+    bool push(T &&value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) return false;
+        slots[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者调用；队列空时返回 false
+    bool pop(T &value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        value = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 只在两端都不活动时调用（例如开始新一轮运行之前）
+    void clear() {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask;
+    // 分在不同的缓存行上，避免生产者和消费者互相抖动
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
+
+#endif // SPSCQUEUE_H
@@ -10,108 +10,138 @@ static std::string indentStr(int n) {
 Statement::Statement() {}
 Statement::~Statement() {}
 
+void Statement::resolve(EvaluationContext &) {}
+void Statement::optimize(Optimizer &) {}
+std::string Statement::getVarName() { return ""; }
+int Statement::getSlot() { return -1; }
+Expression* Statement::getExp() { return nullptr; }
+Expression* Statement::getLHS() { return nullptr; }
+Expression* Statement::getRHS() { return nullptr; }
+std::string Statement::getOperator() { return ""; }
+int Statement::getLineNumber() { return -1; }
+int Statement::getTarget() { return -1; }
+void Statement::setTarget(int) {}
+
 // === RemStmt ===
-RemStmt::RemStmt(std::string comment) : comment(comment) {}
-void RemStmt::execute(EvaluationContext &context) { /* do nothing */ }
-std::string RemStmt::toString(int indent) {
-    return indentStr(indent) + "REM\n" + indentStr(indent + 4) + comment;
+RemStmt::RemStmt(std::string_view comment) : comment(comment) {}
+int RemStmt::execute(EvaluationContext &) { return NEXT_PC; }
+std::string RemStmt::toString(int indent, bool) {
+    return indentStr(indent) + "REM\n" + indentStr(indent + 4) + std::string(comment);
 }
+StatementType RemStmt::type() { return REM_STMT; }
 
 // === LetStmt ===
-LetStmt::LetStmt(std::string varName, Expression *exp) : name(varName), exp(exp) {}
-LetStmt::~LetStmt() { delete exp; }
+LetStmt::LetStmt(std::string_view varName, Expression *exp) : name(varName), exp(exp), source(exp) {}
 
-void LetStmt::execute(EvaluationContext &context) {
+int LetStmt::execute(EvaluationContext &context) {
     int val = exp->eval(context);
-    context.setValue(name, val);
+    context.setSlot(slot, val);
+    return NEXT_PC;
+}
+
+void LetStmt::resolve(EvaluationContext &context) {
+    slot = context.slotOf(std::string(name));
+    exp->resolve(context);
 }
 
-std::string LetStmt::toString(int indent) {
+void LetStmt::optimize(Optimizer &optimizer) {
+    exp = optimizer.optimize(source);
+}
+
+std::string LetStmt::toString(int indent, bool optimized) {
     std::string str = indentStr(indent) + "LET =\n";
-    str += indentStr(indent + 4) + name + "\n";
+    str += indentStr(indent + 4) + std::string(name) + "\n";
     // 现在的 exp->toString 会自带换行，并且会基于 indent+4 进行缩进
-    str += exp->toString(indent + 4);
+    str += (optimized ? exp : source)->toString(indent + 4);
     return str;
 }
+StatementType LetStmt::type() { return LET_STMT; }
+std::string LetStmt::getVarName() { return std::string(name); }
+int LetStmt::getSlot() { return slot; }
+Expression* LetStmt::getExp() { return exp; }
 
 // === PrintStmt ===
-PrintStmt::PrintStmt(Expression *exp) : exp(exp) {}
-PrintStmt::~PrintStmt() { delete exp; }
-void PrintStmt::execute(EvaluationContext &context) {
+PrintStmt::PrintStmt(Expression *exp) : exp(exp), source(exp) {}
+int PrintStmt::execute(EvaluationContext &context) {
     int val = exp->eval(context);
     // 调用 Context 的输出能力
     context.writeOutput(std::to_string(val));
+    return NEXT_PC;
 }
 
 
-std::string PrintStmt::toString(int indent) {
+std::string PrintStmt::toString(int indent, bool optimized) {
     std::string str = indentStr(indent) + "PRINT\n";
-    str += exp->toString(indent + 4);
+    str += (optimized ? exp : source)->toString(indent + 4);
     return str;
 }
+StatementType PrintStmt::type() { return PRINT_STMT; }
+void PrintStmt::resolve(EvaluationContext &context) { exp->resolve(context); }
+void PrintStmt::optimize(Optimizer &optimizer) { exp = optimizer.optimize(source); }
+Expression* PrintStmt::getExp() { return exp; }
 
 // === EndStmt ===
 EndStmt::EndStmt() {}
 
-void EndStmt::execute(EvaluationContext &context) {
-    // 抛出结束信号，打断执行流
-    throw EndSignal();
+int EndStmt::execute(EvaluationContext &) {
+    // 返回结束信号，打断执行流
+    return HALT_PC;
 }
 
-std::string EndStmt::toString(int indent) {
+std::string EndStmt::toString(int indent, bool) {
     return indentStr(indent) + "END\n";
 }
+StatementType EndStmt::type() { return END_STMT; }
 
 // === InputStmt ===
-InputStmt::InputStmt(std::string varName) : name(varName) {}
-void InputStmt::execute(EvaluationContext &context) {
+InputStmt::InputStmt(std::string_view varName) : name(varName) {}
+int InputStmt::execute(EvaluationContext &context) {
     // 1. 读取输入
-    int val = context.readInput(name);
+    int val = context.readInput(context.slotName(slot));
 
     // 2. 存入变量
-    context.setValue(name, val);
+    context.setSlot(slot, val);
 
     // 【新增】调试信息 (调试完可以注释掉)
     // 这样你就能看到到底发生了什么
     // 使用 context.writeOutput 打印到屏幕，或者 qDebug() 打印到后台
     //context.writeOutput("[Debug] INPUT " + name + " got value: " + std::to_string(val));
+    return NEXT_PC;
 }
-std::string InputStmt::toString(int indent) {
-    return indentStr(indent) + "INPUT\n" + indentStr(indent + 4) + name;
+std::string InputStmt::toString(int indent, bool) {
+    return indentStr(indent) + "INPUT\n" + indentStr(indent + 4) + std::string(name);
 }
+StatementType InputStmt::type() { return INPUT_STMT; }
+void InputStmt::resolve(EvaluationContext &context) { slot = context.slotOf(std::string(name)); }
+std::string InputStmt::getVarName() { return std::string(name); }
+int InputStmt::getSlot() { return slot; }
 
 // === GotoStmt ===
 GotoStmt::GotoStmt(int lineNumber) : lineNumber(lineNumber) {}
-void GotoStmt::execute(EvaluationContext &context) {
-    // 抛出跳转信号
-    throw GotoSignal(lineNumber);
+int GotoStmt::execute(EvaluationContext &) {
+    // 返回已链接好的跳转目标
+    return target;
 }
-std::string GotoStmt::toString(int indent) {
+std::string GotoStmt::toString(int indent, bool) {
     return indentStr(indent) + "GOTO\n" + indentStr(indent + 4) + std::to_string(lineNumber);
 }
 int GotoStmt::getLineNumber() { return lineNumber; }
+int GotoStmt::getTarget() { return target; }
+void GotoStmt::setTarget(int pc) { target = pc; }
+StatementType GotoStmt::type() { return GOTO_STMT; }
 
 // === IfStmt ===
-IfStmt::IfStmt(Expression *lhs, std::string op, Expression *rhs, int lineNumber)
-    : lhs(lhs), op(op), rhs(rhs), lineNumber(lineNumber) {}
-IfStmt::~IfStmt() { delete lhs; delete rhs; }
-
-void IfStmt::execute(EvaluationContext &context) {
-    // 1. 计算左右表达式
-    int l = lhs->eval(context);
-    int r = rhs->eval(context);
-
-    // 2. 判断条件
-    bool conditionMet = false;
-    if (op == "=") conditionMet = (l == r);
-    else if (op == "<") conditionMet = (l < r);
-    else if (op == ">") conditionMet = (l > r);
-
-    // 3. 如果满足，抛出跳转信号
-    if (conditionMet) {
-        throw GotoSignal(lineNumber);
+IfStmt::IfStmt(Expression *lhs, std::string_view op, Expression *rhs, int lineNumber)
+    : lhs(lhs), op(op), rhs(rhs), sourceLhs(lhs), sourceRhs(rhs), lineNumber(lineNumber) {}
+
+int IfStmt::execute(EvaluationContext &context) {
+    // 1. 计算左右表达式并判断条件
+    // 2. 如果满足，返回跳转目标
+    if (checkCondition(context)) {
+        return target;
     }
-    // 如果不满足，什么都不做，程序自然执行下一行
+    // 如果不满足，程序自然执行下一行
+    return NEXT_PC;
 }
 bool IfStmt::checkCondition(EvaluationContext &context) {
     int l = lhs->eval(context);
@@ -122,12 +152,26 @@ bool IfStmt::checkCondition(EvaluationContext &context) {
     return false;
 }
 int IfStmt::getLineNumber() { return lineNumber; }
+int IfStmt::getTarget() { return target; }
+void IfStmt::setTarget(int pc) { target = pc; }
+StatementType IfStmt::type() { return IF_STMT; }
+void IfStmt::resolve(EvaluationContext &context) {
+    lhs->resolve(context);
+    rhs->resolve(context);
+}
+void IfStmt::optimize(Optimizer &optimizer) {
+    lhs = optimizer.optimize(sourceLhs);
+    rhs = optimizer.optimize(sourceRhs);
+}
+Expression* IfStmt::getLHS() { return lhs; }
+Expression* IfStmt::getRHS() { return rhs; }
+std::string IfStmt::getOperator() { return std::string(op); }
 
-std::string IfStmt::toString(int indent) {
+std::string IfStmt::toString(int indent, bool optimized) {
     std::string str = indentStr(indent) + "IF THEN\n";
-    str += lhs->toString(indent + 4);
-    str += indentStr(indent + 4) + op + "\n";
-    str += rhs->toString(indent + 4);
+    str += (optimized ? lhs : sourceLhs)->toString(indent + 4);
+    str += indentStr(indent + 4) + std::string(op) + "\n";
+    str += (optimized ? rhs : sourceRhs)->toString(indent + 4);
     str += indentStr(indent + 4) + std::to_string(lineNumber) + "\n";
     return str;
 }
@@ -2,122 +2,169 @@
 #define STATEMENT_H
 
 #include "expression.h"
+#include "optimizer.h"
 #include <string>
+#include <string_view>
 #include <stdexcept>
 
-// 定义一个特殊的异常，用于传递 END 信号
-class EndSignal : public std::exception {
-    // 不需要任何内容，它只是一个信号
-};
-
-// 【新增】跳转信号
-class GotoSignal : public std::exception {
-public:
-    int targetLine;
-    GotoSignal(int line) : targetLine(line) {}
-};
+// 语句种类（供字节码编译器等按种类访问语句内容）
+enum StatementType { REM_STMT, LET_STMT, PRINT_STMT, INPUT_STMT, GOTO_STMT, IF_STMT, END_STMT };
 
 // === 语句基类 ===
+// 【修改】语句和它的表达式一样分配在 Arena 中，随 Arena 整体释放
 class Statement {
 public:
     Statement();
     virtual ~Statement();
 
+    // execute 的特殊返回值
+    enum { NEXT_PC = -1,   // 顺序执行下一条语句
+           HALT_PC = -2 }; // 程序结束
+
     // 核心功能：执行这条语句
     // 注意：这里需要传入 context，以便修改变量或读取变量
-    // Q: 为什么这还没涉及跳转？
-    // A: 简单的语句只修改数据。GOTO 这种控制流我们稍后在 MainWindow 的循环里处理，
-    //    或者在这里抛出异常/返回特殊值来触发跳转。为了简单，先定义接口。
-    virtual void execute(EvaluationContext &context) = 0;
+    // 返回下一条要执行的语句在 Program 中的下标（或 NEXT_PC / HALT_PC），
+    // 跳转目标由 Program::link 事先解析好，正常执行路径上不抛异常
+    virtual int execute(EvaluationContext &context) = 0;
 
     // 显示语法树（文档要求的缩进显示）
     // indent: 当前缩进层级
-    virtual std::string toString(int indent) = 0;
+    // optimized: 显示优化后的表达式树（默认显示源码对应的原始树）
+    virtual std::string toString(int indent, bool optimized = false) = 0;
+
+    virtual StatementType type() = 0;
+
+    // 【新增】符号解析：把语句里出现的变量名换成槽位下标，解析后才能 execute
+    virtual void resolve(EvaluationContext &context);
+
+    // 【新增】表达式优化：执行用的表达式换成优化后的树，原始树保留用于显示
+    virtual void optimize(Optimizer &optimizer);
+
+    // 访问器（与 Expression 一样，基类返回空值，子类按需覆盖）
+    virtual std::string getVarName();   // LET / INPUT 的变量名
+    virtual int getSlot();              // LET / INPUT 变量的槽位，解析前为 -1
+    virtual Expression *getExp();       // LET / PRINT 的表达式（执行用，可能已优化）
+    virtual Expression *getLHS();       // IF 左侧表达式（执行用，可能已优化）
+    virtual Expression *getRHS();       // IF 右侧表达式（执行用，可能已优化）
+    virtual std::string getOperator();  // IF 比较符
+    virtual int getLineNumber();        // GOTO / IF 的跳转目标
+    virtual int getTarget();            // GOTO / IF 跳转目标在 Program 中的下标，链接前为 -1
+    virtual void setTarget(int pc);     // 由 Program::link 调用
 };
 
 // 1. REM 语句
 class RemStmt : public Statement {
 public:
-    RemStmt(std::string comment);
-    virtual void execute(EvaluationContext &context) override;
-    virtual std::string toString(int indent) override;
+    RemStmt(std::string_view comment);
+    virtual int execute(EvaluationContext &context) override;
+    virtual std::string toString(int indent, bool optimized = false) override;
+    virtual StatementType type() override;
 private:
-    std::string comment;
+    std::string_view comment;
 };
 
 // 2. LET 语句 (LET var = exp)
 class LetStmt : public Statement {
 public:
-    LetStmt(std::string varName, Expression *exp);
-    virtual ~LetStmt();
-    virtual void execute(EvaluationContext &context) override;
-    virtual std::string toString(int indent) override;
+    LetStmt(std::string_view varName, Expression *exp);
+    virtual int execute(EvaluationContext &context) override;
+    virtual std::string toString(int indent, bool optimized = false) override;
+    virtual StatementType type() override;
+    virtual void resolve(EvaluationContext &context) override;
+    virtual void optimize(Optimizer &optimizer) override;
+    virtual std::string getVarName() override;
+    virtual int getSlot() override;
+    virtual Expression *getExp() override;
 private:
-    std::string name;
-    Expression *exp;
+    std::string_view name;
+    int slot = -1;
+    Expression *exp;    // 执行用
+    Expression *source; // 解析得到的原始树
 };
 
 // 3. PRINT 语句 (PRINT exp)
 class PrintStmt : public Statement {
 public:
     PrintStmt(Expression *exp);
-    virtual ~PrintStmt();
-    virtual void execute(EvaluationContext &context) override;
-    virtual std::string toString(int indent) override;
+    virtual int execute(EvaluationContext &context) override;
+    virtual std::string toString(int indent, bool optimized = false) override;
+    virtual StatementType type() override;
+    virtual void resolve(EvaluationContext &context) override;
+    virtual void optimize(Optimizer &optimizer) override;
+    virtual Expression *getExp() override;
 private:
-    Expression *exp;
+    Expression *exp;    // 执行用
+    Expression *source; // 解析得到的原始树
 };
 
 // 4. INPUT 语句 (INPUT var)
 class InputStmt : public Statement {
 public:
-    InputStmt(std::string varName);
-    virtual void execute(EvaluationContext &context) override;
-    virtual std::string toString(int indent) override;
+    InputStmt(std::string_view varName);
+    virtual int execute(EvaluationContext &context) override;
+    virtual std::string toString(int indent, bool optimized = false) override;
+    virtual StatementType type() override;
+    virtual void resolve(EvaluationContext &context) override;
+    virtual std::string getVarName() override;
+    virtual int getSlot() override;
 private:
-    std::string name;
+    std::string_view name;
+    int slot = -1;
 };
 
 // 5. END 语句
 class EndStmt : public Statement {
 public:
     EndStmt();
-    virtual void execute(EvaluationContext &context) override;
-    virtual std::string toString(int indent) override;
+    virtual int execute(EvaluationContext &context) override;
+    virtual std::string toString(int indent, bool optimized = false) override;
+    virtual StatementType type() override;
 };
 
 // --- GOTO 和 IF 比较特殊，它们需要改变程序执行流 ---
-// 我们将在 "execute" 中抛出特殊异常来实现跳转，或者让 execute 返回下一行的行号。
-// 这里先定义数据结构。
+// 行号在解析时保存，Program::link 把它换成语句下标，execute 直接返回该下标。
 
 // 6. GOTO 语句 (GOTO n)
 class GotoStmt : public Statement {
 public:
     GotoStmt(int lineNumber);
-    virtual void execute(EvaluationContext &context) override;
-    virtual std::string toString(int indent) override;
-    int getLineNumber(); // 特殊访问器
+    virtual int execute(EvaluationContext &context) override;
+    virtual std::string toString(int indent, bool optimized = false) override;
+    virtual StatementType type() override;
+    virtual int getLineNumber() override; // 特殊访问器
+    virtual int getTarget() override;
+    virtual void setTarget(int pc) override;
 private:
     int lineNumber;
+    int target = -1;
 };
 
 // 7. IF 语句 (IF exp1 op exp2 THEN n)
 class IfStmt : public Statement {
 public:
-    IfStmt(Expression *lhs, std::string op, Expression *rhs, int lineNumber);
-    virtual ~IfStmt();
-    virtual void execute(EvaluationContext &context) override;
-    virtual std::string toString(int indent) override;
+    IfStmt(Expression *lhs, std::string_view op, Expression *rhs, int lineNumber);
+    virtual int execute(EvaluationContext &context) override;
+    virtual std::string toString(int indent, bool optimized = false) override;
+    virtual StatementType type() override;
+    virtual void resolve(EvaluationContext &context) override;
+    virtual void optimize(Optimizer &optimizer) override;
+    virtual Expression *getLHS() override;
+    virtual Expression *getRHS() override;
+    virtual std::string getOperator() override;
 
     // 获取跳转目标和判断条件
-    int getLineNumber();
+    virtual int getLineNumber() override;
+    virtual int getTarget() override;
+    virtual void setTarget(int pc) override;
     bool checkCondition(EvaluationContext &context);
 
 private:
     Expression *lhs;
-    std::string op; // =, <, >
+    std::string_view op; // =, <, >
     Expression *rhs;
+    Expression *sourceLhs, *sourceRhs; // 解析得到的原始树
     int lineNumber;
+    int target = -1;
 };
 
 #endif // STATEMENT_H
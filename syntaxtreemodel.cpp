@@ -0,0 +1,143 @@
+#include "syntaxtreemodel.h"
+#include <QStringList>
+
+SyntaxTreeModel::SyntaxTreeModel(QObject *parent)
+    : QAbstractItemModel(parent)
+{
+}
+
+void SyntaxTreeModel::setProgram(const Program &program, bool optimized)
+{
+    beginResetModel();
+    entries.clear();
+    nodes.clear();
+    entries.reserve(program.size());
+    for (int pc = 0; pc < program.size(); pc++) {
+        Entry entry;
+        entry.lineNumber = program.lineAt(pc);
+        entry.stmt = program.at(pc);
+        entries.push_back(entry);
+    }
+    this->optimized = optimized;
+    endResetModel();
+}
+
+void SyntaxTreeModel::clear()
+{
+    beginResetModel();
+    entries.clear();
+    nodes.clear();
+    endResetModel();
+}
+
+// 生成一条语句的语法树文本，按缩进（每层 4 个空格）拆成节点
+void SyntaxTreeModel::build(int stmt) const
+{
+    Entry &entry = entries[stmt];
+    if (entry.built) return;
+    entry.built = true;
+
+    if (!entry.stmt) { // 【新增】延迟解析时还没执行到的行
+        entry.label = QString::number(entry.lineNumber) + " (not parsed)";
+        return;
+    }
+
+    QString text = QString::fromStdString(entry.stmt->toString(0, optimized));
+    QStringList lines = text.split('\n', Qt::SkipEmptyParts);
+    if (lines.isEmpty()) {
+        entry.label = QString::number(entry.lineNumber);
+        return;
+    }
+    entry.label = QString::number(entry.lineNumber) + " " + lines[0];
+
+    // path[d] 是当前深度 d 上最近的节点；深度 0 是语句本身，用 -1 表示
+    std::vector<int> path{-1};
+    for (int i = 1; i < lines.size(); i++) {
+        const QString &line = lines[i];
+        int spaces = 0;
+        while (spaces < line.size() && line[spaces] == ' ') spaces++;
+        int depth = qBound(1, spaces / 4, (int)path.size());
+
+        int parent = path[depth - 1];
+        std::vector<int> &siblings = parent < 0 ? entry.children : nodes[parent].children;
+
+        Node node;
+        node.text = line.mid(spaces);
+        node.stmt = stmt;
+        node.parent = parent;
+        node.row = (int)siblings.size();
+        int id = (int)nodes.size();
+        siblings.push_back(id); // 先登记再追加：push_back 可能让 nodes 扩容，siblings 随之失效
+        nodes.push_back(node);
+
+        path.resize(depth);
+        path.push_back(id);
+    }
+}
+
+QModelIndex SyntaxTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (column != 0 || row < 0) return QModelIndex();
+
+    if (!parent.isValid()) {
+        if (row >= (int)entries.size()) return QModelIndex();
+        return createIndex(row, 0, quintptr(0));
+    }
+
+    const std::vector<int> *children;
+    if (parent.internalId() == 0) {
+        build(parent.row());
+        children = &entries[parent.row()].children;
+    } else {
+        children = &nodes[parent.internalId() - 1].children;
+    }
+    if (row >= (int)children->size()) return QModelIndex();
+    return createIndex(row, 0, quintptr((*children)[row] + 1));
+}
+
+QModelIndex SyntaxTreeModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid() || child.internalId() == 0) return QModelIndex();
+
+    const Node &node = nodes[child.internalId() - 1];
+    if (node.parent < 0) return createIndex(node.stmt, 0, quintptr(0));
+    return createIndex(nodes[node.parent].row, 0, quintptr(node.parent + 1));
+}
+
+int SyntaxTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) return (int)entries.size();
+    if (parent.column() != 0) return 0;
+    if (parent.internalId() == 0) {
+        build(parent.row());
+        return (int)entries[parent.row()].children.size();
+    }
+    return (int)nodes[parent.internalId() - 1].children.size();
+}
+
+int SyntaxTreeModel::columnCount(const QModelIndex &) const
+{
+    return 1;
+}
+
+bool SyntaxTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) return !entries.empty();
+    // 顶层：END 没有子节点，其余语句都有，不必为了画展开箭头先生成文本
+    if (parent.internalId() == 0) {
+        const Statement *stmt = entries[parent.row()].stmt;
+        return stmt && stmt->type() != END_STMT;
+    }
+    return !nodes[parent.internalId() - 1].children.empty();
+}
+
+QVariant SyntaxTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+
+    if (index.internalId() == 0) {
+        build(index.row());
+        return entries[index.row()].label;
+    }
+    return nodes[index.internalId() - 1].text;
+}
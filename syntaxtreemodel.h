@@ -0,0 +1,58 @@
+#ifndef SYNTAXTREEMODEL_H
+#define SYNTAXTREEMODEL_H
+
+#include "program.h"
+#include <QAbstractItemModel>
+#include <vector>
+
+// === 语法树窗口的数据模型 ===
+// 顶层每一行是一条语句（"10 LET ="），展开后是它的语法树，层次与 Statement::toString 的缩进一致。
+// 只有视图真正需要显示某条语句时（可见的行或展开的节点）才调用 toString 并拆出子节点，
+// RUN 时只记下语句指针，不再为整个程序预先生成语法树文本。
+// 语句归 ParseCache 所有：缓存释放语句之前必须先 clear()
+// 【新增】延迟解析的程序中还没解析的行显示为 "行号 (not parsed)"，没有子节点
+class SyntaxTreeModel : public QAbstractItemModel {
+    Q_OBJECT
+
+public:
+    SyntaxTreeModel(QObject *parent = nullptr);
+
+    // 换成新的程序视图；optimized 选择显示优化后还是源码对应的表达式树
+    void setProgram(const Program &program, bool optimized);
+    void clear();
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    // 语法树中的一个节点（toString 的一行）
+    struct Node {
+        QString text;
+        int stmt;                 // 所属语句的下标
+        int parent;               // 父节点下标，-1 表示直接挂在语句下
+        int row;                  // 在父节点中的行号
+        std::vector<int> children;
+    };
+
+    // 一条语句
+    struct Entry {
+        int lineNumber;
+        Statement *stmt;
+        bool built = false;       // 是否已经生成过文本和子节点
+        QString label;
+        std::vector<int> children;
+    };
+
+    // 节点的 internalId：0 表示顶层语句，其余为 nodes 下标 + 1
+    mutable std::vector<Entry> entries;
+    mutable std::vector<Node> nodes;
+    bool optimized = false;
+
+    void build(int stmt) const;
+};
+
+#endif // SYNTAXTREEMODEL_H
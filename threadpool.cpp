@@ -0,0 +1,106 @@
+#include "threadpool.h"
+
+// 当前线程所属的线程池和队列下标（不是工作线程时为 nullptr / -1）
+static thread_local WorkStealingPool *currentPool = nullptr;
+static thread_local int currentQueue = -1;
+
+WorkStealingPool::WorkStealingPool(int threads) {
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+
+    for (int i = 0; i < threads; i++) queues.push_back(std::make_unique<Queue>());
+    for (int i = 0; i < threads; i++) workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        done.wait(lock, [this]() { return pending.load() == 0; });
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &t : workers) t.join();
+}
+
+void WorkStealingPool::submit(Task task) {
+    int id = currentPool == this ? currentQueue : (int)(nextQueue.fetch_add(1) % queues.size());
+    pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues[id]->mutex);
+        queues[id]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued.fetch_add(1);
+    }
+    wake.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(doneMutex);
+    done.wait(lock, [this]() { return pending.load() == 0; });
+    if (firstError) {
+        std::exception_ptr error = firstError;
+        firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool WorkStealingPool::popLocal(int id, Task &task) {
+    Queue &q = *queues[id];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) return false;
+    task = std::move(q.tasks.front());
+    q.tasks.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::steal(int id, Task &task) {
+    int n = (int)queues.size();
+    for (int k = 1; k < n; k++) {
+        Queue &q = *queues[(id + k) % n];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) continue;
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::runTask(Task &task) {
+    queued.fetch_sub(1);
+    try {
+        task();
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        if (!firstError) firstError = std::current_exception();
+    }
+    task = nullptr; // 在计数之前释放任务捕获的资源
+
+    if (pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        done.notify_all();
+    }
+}
+
+void WorkStealingPool::workerLoop(int id) {
+    currentPool = this;
+    currentQueue = id;
+
+    Task task;
+    while (true) {
+        if (popLocal(id, task) || steal(id, task)) {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]() { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0) return;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// === 工作窃取线程池 ===
+// 每个工作线程有自己的任务队列，按提交顺序从队头取（先进先出），
+// 自己的队列空了就从其他线程的队头偷。调用方按开销从大到小提交时（见 grade），
+// 每个线程都先做自己队列里最大的任务，小任务留到最后填空。
+// 外部线程提交的任务轮流放进各个队列；任务在工作线程里再提交的子任务放进当前线程的队列。
+// 每个队列各有一把锁，只有同一个队列上的取和偷会互相等待。
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // threads <= 0 时使用 CPU 核数
+    explicit WorkStealingPool(int threads = 0);
+    ~WorkStealingPool(); // 等待已提交的任务全部完成后退出
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    void submit(Task task);
+
+    // 阻塞直到已提交的任务全部完成；任务抛出的第一个异常在这里重新抛出
+    void wait();
+
+    int size() const { return (int)workers.size(); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<unsigned> nextQueue{0}; // 外部提交时轮流选择队列
+    std::atomic<int> queued{0};         // 在队列中等待的任务数（只在 sleepMutex 下增加，避免丢失唤醒）
+    std::atomic<int> pending{0};        // 已提交、尚未完成的任务数
+    bool stopping = false;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;       // 有新任务或要退出
+    std::mutex doneMutex;
+    std::condition_variable done;       // pending 变为 0
+    std::exception_ptr firstError;
+
+    void workerLoop(int id);
+    bool popLocal(int id, Task &task);
+    bool steal(int id, Task &task);
+    void runTask(Task &task);
+};
+
+#endif // THREADPOOL_H
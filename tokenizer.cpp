@@ -1,80 +1,94 @@
 #include "tokenizer.h"
 #include <cctype> // 用于 isdigit, isalpha, isspace
 
-Tokenizer::Tokenizer(std::string input) {
-    currentPos = 0;
-    tokenize(input);
-}
-
-bool Tokenizer::hasMoreTokens() {
-    return currentPos < tokens.size();
+// 关键字表：按长度和内容判断，区分大小写
+static TokenId keywordId(std::string_view word) {
+    switch (word.size()) {
+    case 2:
+        if (word == "IF") return TK_IF;
+        break;
+    case 3:
+        if (word == "REM") return TK_REM;
+        if (word == "LET") return TK_LET;
+        if (word == "END") return TK_END;
+        if (word == "MOD") return TK_MOD;
+        break;
+    case 4:
+        if (word == "GOTO") return TK_GOTO;
+        if (word == "THEN") return TK_THEN;
+        break;
+    case 5:
+        if (word == "PRINT") return TK_PRINT;
+        if (word == "INPUT") return TK_INPUT;
+        break;
+    }
+    return TK_NONE;
 }
 
-std::string Tokenizer::nextToken() {
-    if (!hasMoreTokens()) return "";
-    return tokens[currentPos++];
+Tokenizer::Tokenizer(std::string_view input) : input(input) {
+    lookahead = scan();
 }
 
-std::string Tokenizer::peekToken() {
-    if (!hasMoreTokens()) return "";
-    return tokens[currentPos];
+Token Tokenizer::nextToken() {
+    Token token = lookahead;
+    if (token.kind != TOKEN_END) lookahead = scan();
+    return token;
 }
 
 // 核心切割逻辑
-void Tokenizer::tokenize(std::string input) {
-    int len = input.length();
-    int i = 0;
+Token Tokenizer::scan() {
+    size_t len = input.size();
 
-    while (i < len) {
-        char c = input[i];
+    // 1. 跳过空白字符 (空格, Tab)
+    while (pos < len && std::isspace((unsigned char)input[pos])) pos++;
 
-        // 1. 跳过空白字符 (空格, Tab)
-        if (std::isspace(c)) {
-            i++;
-            continue;
-        }
+    if (pos >= len) return {TOKEN_END, TK_NONE, std::string_view()};
 
-        // 2. 处理数字 (Integers)
-        if (std::isdigit(c)) {
-            std::string number;
-            while (i < len && std::isdigit(input[i])) {
-                number += input[i];
-                i++;
-            }
-            tokens.push_back(number);
-        }
-        // 3. 处理标识符 (Variables 或 关键字如 MOD, LET, IF)
-        // 规则：以字母开头，后面可以是字母或数字
-        else if (std::isalpha(c)) {
-            std::string ident;
-            while (i < len && (std::isalnum(input[i]))) {
-                ident += input[i];
-                i++;
-            }
-            tokens.push_back(ident);
-        }
-        // 4. 处理操作符 (Operators)
-        else {
-            std::string op;
-            op += c;
+    size_t start = pos;
+    unsigned char c = input[pos];
 
-            // 检查是否是双字符操作符 (**, <=, >=, <>)
-            if (i + 1 < len) {
-                char nextC = input[i + 1];
-                bool isDouble = false;
+    // 2. 处理数字 (Integers)
+    if (std::isdigit(c)) {
+        while (pos < len && std::isdigit((unsigned char)input[pos])) pos++;
+        return {TOKEN_NUMBER, TK_NONE, input.substr(start, pos - start)};
+    }
 
-                if (c == '*' && nextC == '*') isDouble = true; // 幂运算 **
-                else if (c == '<' && nextC == '=') isDouble = true;
-                else if (c == '>' && nextC == '=') isDouble = true;
+    // 3. 处理标识符 (Variables 或 关键字如 MOD, LET, IF)
+    // 规则：以字母开头，后面可以是字母或数字
+    if (std::isalpha(c)) {
+        while (pos < len && std::isalnum((unsigned char)input[pos])) pos++;
+        std::string_view word = input.substr(start, pos - start);
+        TokenId id = keywordId(word);
+        return {id == TK_NONE ? TOKEN_IDENTIFIER : TOKEN_KEYWORD, id, word};
+    }
 
-                if (isDouble) {
-                    op += nextC;
-                    i++; // 多跳过一个字符
-                }
-            }
+    // 4. 处理操作符 (Operators)
+    // 检查是否是双字符操作符 (**, <=, >=)
+    char nextC = pos + 1 < len ? input[pos + 1] : '\0';
+    TokenId id = TK_OTHER;
+    size_t width = 1;
 
-            tokens.push_back(op);
-            i++;
-        }
+    switch (c) {
+    case '+': id = TK_PLUS; break;
+    case '-': id = TK_MINUS; break;
+    case '/': id = TK_SLASH; break;
+    case '(': id = TK_LPAREN; break;
+    case ')': id = TK_RPAREN; break;
+    case '=': id = TK_EQ; break;
+    case '*':
+        if (nextC == '*') { id = TK_POW; width = 2; } // 幂运算 **
+        else id = TK_STAR;
+        break;
+    case '<':
+        if (nextC == '=') { id = TK_LE; width = 2; }
+        else id = TK_LT;
+        break;
+    case '>':
+        if (nextC == '=') { id = TK_GE; width = 2; }
+        else id = TK_GT;
+        break;
     }
+
+    pos += width;
+    return {TOKEN_OPERATOR, id, input.substr(start, width)};
 }
@@ -2,29 +2,59 @@
 #define TOKENIZER_H
 
 #include <string>
-#include <vector>
+#include <string_view>
+
+// Token 的大类
+enum TokenKind : unsigned char {
+    TOKEN_END,        // 没有更多 Token
+    TOKEN_NUMBER,     // 整数常量
+    TOKEN_IDENTIFIER, // 变量名
+    TOKEN_KEYWORD,    // LET, PRINT, MOD ...
+    TOKEN_OPERATOR    // + - * / ** ( ) = < > <= >= 以及其他单个符号
+};
+
+// 关键字 / 运算符编号，Parser 直接 switch，不再比较字符串
+enum TokenId : unsigned char {
+    TK_NONE,
+    // 关键字
+    TK_REM, TK_LET, TK_PRINT, TK_INPUT, TK_GOTO, TK_IF, TK_THEN, TK_END, TK_MOD,
+    // 运算符
+    TK_PLUS, TK_MINUS, TK_STAR, TK_SLASH, TK_POW,
+    TK_LPAREN, TK_RPAREN, TK_EQ, TK_LT, TK_GT, TK_LE, TK_GE,
+    TK_OTHER // 其他不认识的单个符号
+};
+
+struct Token {
+    TokenKind kind;
+    TokenId id;
+    std::string_view text; // 指向源码中的原文，不拷贝
+};
 
 // 词法分析器
-// 职责：将字符串 "10 + A" 切割成 ["10", "+", "A"]
+// 职责：将字符串 "10 + A" 切割成 [NUMBER 10, OPERATOR +, IDENTIFIER A]
+// 【修改】按需逐个扫描，只保留一个预读 Token，不再为每个 Token 分配 std::string；
+// Token::text 指向 input，所以 input 必须比 Tokenizer 活得久
 class Tokenizer {
 public:
-    Tokenizer(std::string input);
+    Tokenizer(std::string_view input);
+    Tokenizer(std::string &&input) = delete; // 禁止传入临时字符串，防止 Token 悬空
 
-    // 获取下一个 Token，如果没有了返回空字符串 ""
-    std::string nextToken();
+    // 获取下一个 Token，如果没有了返回 TOKEN_END
+    Token nextToken();
 
     // 查看下一个 Token 但不消耗它（用于预读）
-    std::string peekToken();
+    const Token &peekToken() const { return lookahead; }
 
     // 检查是否还有 Token
-    bool hasMoreTokens();
+    bool hasMoreTokens() const { return lookahead.kind != TOKEN_END; }
 
 private:
-    std::vector<std::string> tokens; // 存储切分好的所有 Token
-    int currentPos; // 当前读到第几个 Token 了
+    std::string_view input;
+    size_t pos = 0;  // 下一个未扫描的字符
+    Token lookahead; // 已扫描、尚未被消耗的 Token
 
-    // 核心函数：执行切割逻辑
-    void tokenize(std::string input);
+    // 核心函数：从 pos 开始切出一个 Token
+    Token scan();
 };
 
 #endif // TOKENIZER_H
@@ -0,0 +1,276 @@
+#include "transpiler.h"
+#include <climits>
+#include <stdexcept>
+#include <vector>
+
+// ==========================================================
+// 生成代码的固定部分
+// ==========================================================
+// 运算函数与 arith.h 一致，输入与 io.cpp 的 StdinSource / parseIntLine 一致；修改那边时同步这里。
+// grade/regression/transpile.sh 把回归用例翻译、编译后与树遍历的结果比较，两边不一致时会失败
+
+static const char *PRELUDE = R"(// 由 MiniBasic 从 BASIC 程序翻译生成，编译: c++ -O2 -o program program.cpp
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+// 辅助函数都是 static inline：程序用不到的（例如没有 INPUT 时的 basicInput）不会触发 -Wunused-function
+static inline int basicAdd(int a, int b) { return (int)((unsigned)a + (unsigned)b); }
+static inline int basicSub(int a, int b) { return (int)((unsigned)a - (unsigned)b); }
+static inline int basicMul(int a, int b) { return (int)((unsigned)a * (unsigned)b); }
+
+static inline int basicDiv(int leftVal, int rightVal) {
+    if (rightVal == 0) throw std::runtime_error("Division by zero");
+    if (rightVal == -1 && leftVal == INT_MIN) throw std::runtime_error("Integer overflow in /");
+    return leftVal / rightVal;
+}
+
+static inline int basicMod(int leftVal, int rightVal) {
+    if (rightVal == 0) throw std::runtime_error("Division by zero");
+    if (rightVal == -1) return 0;
+    int r = leftVal % rightVal;
+    if ((rightVal > 0 && r < 0) || (rightVal < 0 && r > 0)) r += rightVal;
+    return r;
+}
+
+static inline int checkedPowResult(long long r) {
+    if (r > INT_MAX || r < INT_MIN) throw std::runtime_error("Integer overflow in **");
+    return (int)r;
+}
+
+static inline int basicPow(int base, int exponent) {
+    if (exponent == 0) return 1;
+    if (exponent == 1) return base;
+    if (exponent < 0) {
+        if (base == 0) throw std::runtime_error("Division by zero");
+        if (base == 1) return 1;
+        if (base == -1) return (exponent & 1) ? -1 : 1;
+        return 0;
+    }
+    long long result = 1;
+    long long b = base;
+    while (true) {
+        if (exponent & 1) result = checkedPowResult(result * b);
+        exponent >>= 1;
+        if (exponent == 0) break;
+        b = checkedPowResult(b * b);
+    }
+    return (int)result;
+}
+
+static inline void basicPrint(int value) {
+    std::printf("%d\n", value);
+}
+
+static inline int basicInput(const char *varName) {
+    std::string line;
+    int c;
+    while ((c = std::fgetc(stdin)) != EOF && c != '\n') line += (char)c;
+    if (c == EOF && line.empty()) throw std::runtime_error(std::string("Unexpected end of input for ") + varName);
+
+    size_t begin = line.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return 0;
+    size_t end = line.find_last_not_of(" \t\r\n");
+    std::string trimmed = line.substr(begin, end - begin + 1);
+    char *stop = nullptr;
+    errno = 0;
+    long val = std::strtol(trimmed.c_str(), &stop, 10);
+    if (*stop != '\0' || errno == ERANGE || val < INT_MIN || val > INT_MAX) return 0;
+    return (int)val;
+}
+
+)";
+
+static const char *MAIN = R"(
+int main() {
+    try {
+        run();
+    }
+    catch (std::exception &e) {
+        std::fflush(stdout);
+        std::fprintf(stderr, "Runtime Error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
+)";
+
+// ==========================================================
+// CppTranspiler 实现
+// ==========================================================
+
+std::string CppTranspiler::translate(const Program &program) {
+    int n = program.size();
+    variables.clear();
+
+    // 只给跳转目标生成标号，避免大量未使用标号的警告
+    std::vector<char> isTarget(n, 0);
+    for (int i = 0; i < n; i++) {
+        Statement *stmt = program.at(i);
+        if (stmt->type() == GOTO_STMT || stmt->type() == IF_STMT) isTarget[stmt->getTarget()] = 1;
+    }
+
+    std::string body;
+    for (int i = 0; i < n; i++) {
+        out.clear();
+        temps = 0;
+        translateStatement(program.at(i), program);
+
+        int lineNumber = program.lineAt(i);
+        body += isTarget[i] ? label(lineNumber) + ":\n" : "    // " + std::to_string(lineNumber) + "\n";
+        // 有临时变量时放进一个块里，goto 不会跳过它们的初始化
+        if (temps > 0) body += "    {\n" + indented(out, "        ") + "    }\n";
+        else body += indented(out, "    ");
+    }
+
+    std::string code = PRELUDE;
+    code += "static void run() {\n";
+    // 只赋值、从不读取的变量也照样声明（LET 仍要求值，可能报错），标上 maybe_unused 免得警告
+    for (const std::string &name : variables) code += "    [[maybe_unused]] int " + variable(name) + " = 0;\n";
+    if (!variables.empty()) code += "\n";
+    code += body;
+    code += "}\n";
+    code += MAIN;
+    return code;
+}
+
+void CppTranspiler::translateStatement(Statement *stmt, const Program &program) {
+    switch (stmt->type()) {
+    case REM_STMT:
+        out += ";\n";
+        break;
+
+    case LET_STMT: {
+        std::string value = translateExpression(stmt->getExp());
+        variables.insert(stmt->getVarName());
+        out += variable(stmt->getVarName()) + " = " + value + ";\n";
+        break;
+    }
+
+    case PRINT_STMT:
+        out += "basicPrint(" + translateExpression(stmt->getExp()) + ");\n";
+        break;
+
+    case INPUT_STMT: {
+        std::string name = stmt->getVarName();
+        variables.insert(name);
+        out += variable(name) + " = basicInput(" + stringLiteral(name) + ");\n";
+        break;
+    }
+
+    case GOTO_STMT:
+        out += "goto " + label(program.lineAt(stmt->getTarget())) + ";\n";
+        break;
+
+    case IF_STMT: {
+        // 先左后右：两边都可能出错时左边先存进临时变量，保证报告的错误与树遍历相同
+        Expression *lhs = stmt->getLHS();
+        Expression *rhs = stmt->getRHS();
+        std::string l = translateExpression(lhs);
+        if (lhs->type() == COMPOUND && rhs->type() == COMPOUND) l = newTemp(l);
+        std::string r = translateExpression(rhs);
+
+        std::string op = stmt->getOperator();
+        if (op == "=" || op == "<" || op == ">") {
+            out += "if (" + l + (op == "=" ? " == " : " " + op + " ") + r + ") goto " +
+                   label(program.lineAt(stmt->getTarget())) + ";\n";
+        }
+        else {
+            // 与 IfStmt::execute 一致：不认识的比较符视为条件不成立，但两边仍然求值
+            out += "(void)(" + l + ");\n(void)(" + r + ");\n";
+        }
+        break;
+    }
+
+    case END_STMT:
+        out += "return;\n";
+        break;
+    }
+}
+
+std::string CppTranspiler::newTemp(const std::string &value) {
+    std::string name = "t" + std::to_string(temps++);
+    out += "const int " + name + " = " + value + ";\n";
+    return name;
+}
+
+std::string CppTranspiler::translateExpression(Expression *exp) {
+    switch (exp->type()) {
+    case CONSTANT:
+        return constant(exp->getConstantValue());
+
+    case IDENTIFIER:
+        variables.insert(exp->getIdentifierName());
+        return variable(exp->getIdentifierName());
+
+    case COMPOUND: {
+        // 函数参数的求值顺序不确定：两边都可能出错时左边先存进临时变量
+        Expression *lhs = exp->getLHS();
+        Expression *rhs = exp->getRHS();
+        std::string l = translateExpression(lhs);
+        if (lhs->type() == COMPOUND && rhs->type() == COMPOUND) l = newTemp(l);
+        std::string r = translateExpression(rhs);
+
+        std::string op = exp->getOperator();
+        const char *fn;
+        if (op == "+") fn = "basicAdd";
+        else if (op == "-") fn = "basicSub";
+        else if (op == "*") fn = "basicMul";
+        else if (op == "/") fn = "basicDiv";
+        else if (op == "MOD") fn = "basicMod";
+        else if (op == "**") fn = "basicPow";
+        else throw std::runtime_error("Illegal operator: " + op);
+        return std::string(fn) + "(" + l + ", " + r + ")";
+    }
+    }
+    return "0";
+}
+
+// 变量名加前缀，避免与 C++ 关键字和生成代码里的名字冲突；其他字符转成 _xx
+std::string CppTranspiler::variable(const std::string &name) {
+    static const char *hex = "0123456789abcdef";
+    std::string id = "v_";
+    for (unsigned char c : name) {
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) id += (char)c;
+        else {
+            id += '_';
+            id += hex[c >> 4];
+            id += hex[c & 15];
+        }
+    }
+    return id;
+}
+
+std::string CppTranspiler::stringLiteral(const std::string &text) {
+    std::string literal = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') literal += '\\';
+        literal += c;
+    }
+    return literal + "\"";
+}
+
+std::string CppTranspiler::constant(int value) {
+    if (value == INT_MIN) return "(-2147483647 - 1)";
+    if (value < 0) return "(" + std::to_string(value) + ")";
+    return std::to_string(value);
+}
+
+std::string CppTranspiler::indented(const std::string &lines, const std::string &indent) {
+    std::string result;
+    size_t begin = 0;
+    while (begin < lines.size()) {
+        size_t end = lines.find('\n', begin);
+        result += indent + lines.substr(begin, end - begin + 1);
+        begin = end + 1;
+    }
+    return result;
+}
+
+std::string CppTranspiler::label(int lineNumber) {
+    // 行号可能是负数
+    return lineNumber < 0 ? "L_" + std::to_string(-lineNumber) : "L" + std::to_string(lineNumber);
+}
@@ -0,0 +1,37 @@
+#ifndef TRANSPILER_H
+#define TRANSPILER_H
+
+#include "program.h"
+#include <set>
+#include <string>
+
+// === BASIC -> C++ 翻译器 ===
+// 把解析、链接好的程序翻译成一份独立的 C++ 源文件，用系统编译器编译后得到原生可执行文件：
+//   - 每一行是一个标号 L<行号>，GOTO / IF 是直接的 goto
+//   - 每个变量是 run() 里的一个局部 int（未赋值时为 0，与树遍历一致）
+//   - PRINT / INPUT 用 stdio，行为与命令行版本的 StdoutSink / StdinSource 相同
+//   - 除法、MOD、** 的规则和报错与 arith.h 完全一致；运行时错误输出
+//     "Runtime Error: ..." 到标准错误并以 1 退出
+//   - + - * 按补码回绕，与树遍历在常见编译器上的实际结果一致，同时避免生成的代码里出现未定义行为
+// 生成的程序没有执行限制，也不能被 STOP 停止
+class CppTranspiler {
+public:
+    std::string translate(const Program &program);
+
+private:
+    std::string out;                   // 当前语句的代码，每行不带缩进
+    std::set<std::string> variables;   // 出现过的变量名
+    int temps = 0;                     // 当前语句用到的临时变量个数
+
+    void translateStatement(Statement *stmt, const Program &program);
+    std::string translateExpression(Expression *exp);
+    std::string newTemp(const std::string &value);
+
+    static std::string variable(const std::string &name);
+    static std::string constant(int value);
+    static std::string stringLiteral(const std::string &text);
+    static std::string label(int lineNumber);
+    static std::string indented(const std::string &lines, const std::string &indent);
+};
+
+#endif // TRANSPILER_H